@@ -4,12 +4,13 @@
 #
 #-------------------------------------------------
 
-QT       += core gui printsupport
+QT       += core gui printsupport concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets serialport
 
 TARGET = ArduPlot
 TEMPLATE = app
+CONFIG += c++17
 
 # The following define makes your compiler emit warnings if you use
 # any feature of Qt which has been marked as deprecated (the exact warnings
@@ -17,6 +18,7 @@ TEMPLATE = app
 # deprecated API in order to know how to port your code away from it.
 DEFINES += QT_DEPRECATED_WARNINGS
 DEFINES += QCUSTOMPLOT_USE_OPENGL
+DEFINES += QCUSTOMPLOT_USE_CONCURRENT
 
 # You can also make your code fail to compile if you use deprecated APIs.
 # In order to do so, uncomment the following line.
@@ -28,13 +30,41 @@ SOURCES += \
         main.cpp \
         mainwindow.cpp \
     qcustomplot.cpp \
-    serialworker.cpp
+    serialworker.cpp \
+    lineparser.cpp \
+    hostclock.cpp \
+    clocksync.cpp \
+    channelregistry.cpp \
+    framescheduler.cpp \
+    sessionrecorder.cpp \
+    sessionreader.cpp \
+    sessionreplayer.cpp \
+    recordinggraph.cpp \
+    recordingviewer.cpp \
+    spectrumanalyzer.cpp \
+    spectrumviewer.cpp
 
 HEADERS += \
         mainwindow.h \
     qcustomplot.h \
     serialworker.h \
-    config.h
+    config.h \
+    sample.h \
+    spscring.h \
+    lineparser.h \
+    linkstats.h \
+    hostclock.h \
+    clocksync.h \
+    channelregistry.h \
+    framescheduler.h \
+    sessionformat.h \
+    sessionrecorder.h \
+    sessionreader.h \
+    sessionreplayer.h \
+    recordinggraph.h \
+    recordingviewer.h \
+    spectrumanalyzer.h \
+    spectrumviewer.h
 
 FORMS += \
         mainwindow.ui
@@ -0,0 +1,119 @@
+#include "channelregistry.h"
+#include "config.h"
+
+#include <QDebug>
+#include <QSettings>
+#include <QStringList>
+
+ChannelRegistry::ChannelRegistry()
+{
+    channels.resize(MAX_SOURCES * CHANNELS_PER_SOURCE);
+}
+
+void ChannelRegistry::LoadDefaults()
+{
+    struct Default {
+        int id;
+        const char* name;
+        double scale;
+        int plot;
+        Qt::GlobalColor color;
+    };
+    static const Default defaults[] = {
+        { ARD_PID1_INPUT, "Input", SCALE_PID1_INPUT, 0, Qt::red },
+        { ARD_PID1_OUTPUT, "Output", SCALE_PID1_OUTPUT, 0, Qt::blue },
+        { ARD_PID1_SETPOINT, "Setpoint", SCALE_PID1_SETPOINT, 0, Qt::green },
+
+        { ARD_PID2_INPUT, "Input", SCALE_PID2_INPUT, 1, Qt::red },
+        { ARD_PID2_OUTPUT, "Output", SCALE_PID2_OUTPUT, 1, Qt::blue },
+        { ARD_PID2_SETPOINT, "Setpoint", SCALE_PID2_SETPOINT, 1, Qt::green },
+
+        { ARD_PID3_INPUT, "Input", SCALE_PID3_INPUT, 2, Qt::red },
+        { ARD_PID3_OUTPUT, "Output", SCALE_PID3_OUTPUT, 2, Qt::blue },
+        { ARD_PID3_SETPOINT, "Setpoint", SCALE_PID3_SETPOINT, 2, Qt::green },
+    };
+
+    for (const Default& d : defaults) {
+        ChannelInfo info;
+        info.id = PRIMARY_SOURCE * CHANNELS_PER_SOURCE + d.id;
+        info.name = d.name;
+        info.scale = d.scale;
+        info.plot = d.plot;
+        info.color = QColor(d.color);
+        Register(info);
+    }
+}
+
+/*
+ * [PID1_INPUT]
+ * id=1
+ * unit=deg
+ * scale=40
+ * plot=0
+ * color=#ff0000
+ */
+bool ChannelRegistry::LoadFile(const QString& fileName)
+{
+    QSettings settings(fileName, QSettings::IniFormat);
+    if (settings.status() != QSettings::NoError) {
+        return false;
+    }
+
+    for (const QString& group : settings.childGroups()) {
+        settings.beginGroup(group);
+        ChannelInfo info;
+        bool ok = false;
+        info.id = settings.value("id").toInt(&ok);
+        info.name = settings.value("name", group).toString();
+        info.unit = settings.value("unit").toString();
+        info.scale = settings.value("scale", 1.0).toDouble();
+        info.plot = settings.value("plot", -1).toInt();
+        info.color = QColor(settings.value("color", "black").toString());
+        settings.endGroup();
+
+        if (!ok || !Register(info)) {
+            qWarning() << "Ignoring channel" << group << "in" << fileName;
+        }
+    }
+    return true;
+}
+
+bool ChannelRegistry::Register(const ChannelInfo& info)
+{
+    if (info.id < 0 || info.id >= channels.size()) {
+        return false;
+    }
+    channels[info.id] = info;
+    return true;
+}
+
+bool ChannelRegistry::ParseAnnouncement(const QByteArray& text, int channelBase, ChannelInfo* info)
+{
+    QStringList fields = QString::fromUtf8(text).trimmed().split(',');
+    if (fields.size() < 2) {
+        return false;
+    }
+
+    bool ok = false;
+    int channel = fields[0].toInt(&ok);
+    if (!ok || channel < 0 || channel >= CHANNELS_PER_SOURCE) {
+        return false;
+    }
+
+    info->id = channelBase + channel;
+    info->name = fields[1].trimmed();
+    info->unit = fields.value(2).trimmed();
+    info->scale = fields.value(3).toDouble(&ok);
+    if (!ok || info->scale == 0) {
+        info->scale = 1;
+    }
+    info->plot = fields.value(4).toInt(&ok);
+    if (!ok) {
+        info->plot = -1;
+    }
+    info->color = QColor(fields.value(5).trimmed());
+    if (!info->color.isValid()) {
+        info->color = QColor(Qt::black);
+    }
+    return true;
+}
@@ -0,0 +1,46 @@
+#ifndef CHANNELREGISTRY_H
+#define CHANNELREGISTRY_H
+
+#include <QByteArray>
+#include <QColor>
+#include <QMetaType>
+#include <QString>
+#include <QVector>
+
+/* What a channel id means and where it is plotted */
+struct ChannelInfo {
+    int id = -1;
+    QString name;
+    QString unit;
+    double scale = 1; // full scale value, used when "scale graph data" is checked
+    int plot = -1; // index of the target plot, -1 if the channel isn't plotted
+    QColor color;
+
+    bool IsValid() const { return id >= 0; }
+};
+Q_DECLARE_METATYPE(ChannelInfo)
+
+/*
+ * Id-indexed table of every channel of every source (MAX_SOURCES * CHANNELS_PER_SOURCE ids).
+ * Starts with the built-in PID channels of config.h, can be overridden by a config file and
+ * extended at runtime by channel announcements from the devices.
+ */
+class ChannelRegistry {
+public:
+    ChannelRegistry();
+
+    int Size() const { return channels.size(); }
+    const ChannelInfo& Info(int id) const { return channels[id]; }
+
+    void LoadDefaults();
+    bool LoadFile(const QString& fileName); // QSettings ini file, one group per channel
+    bool Register(const ChannelInfo& info); // false if the id is out of range
+
+    // "<id>,<name>,<unit>,<scale>,<plot>,<color>", as sent by a device after CUTE_GET_CHANNEL_INFO
+    static bool ParseAnnouncement(const QByteArray& text, int channelBase, ChannelInfo* info);
+
+private:
+    QVector<ChannelInfo> channels;
+};
+
+#endif // CHANNELREGISTRY_H
@@ -0,0 +1,123 @@
+#include "clocksync.h"
+
+#include <limits>
+
+static const int REFIT_INTERVAL = 16; // pairs between two fits once the window is full
+static const double WRAP_SLACK_SECONDS = 1.0; // arrival jitter allowed when telling a wrap from a reset
+
+ClockSync::ClockSync(double ticksPerSecond, int window)
+    : ticksPerSecond(ticksPerSecond)
+    , window(window)
+{
+    pairTicks.resize(window);
+    pairHostNs.resize(window);
+    Reset();
+}
+
+void ClockSync::Reset()
+{
+    next = 0;
+    count = 0;
+    sinceFit = 0;
+    refTicks = 0;
+    refHostNs = 0;
+    nsPerTick = 1e9 / ticksPerSecond;
+    haveLastRaw = false;
+    wraps = 0;
+}
+
+qint64 ClockSync::Unwrap(quint32 ticks, qint64 hostNs)
+{
+    if (haveLastRaw && ticks < lastRaw) {
+        /* the counter went back: a wrap only if the host saw about as much time pass as the wrap
+           implies, otherwise the device was reset and the pairs so far belong to another base */
+        const double wrapTicks = 4294967296.0 - lastRaw + ticks;
+        const double elapsedTicks = double(hostNs - lastRawHostNs) / nsPerTick;
+        if (wrapTicks <= elapsedTicks * 1.01 + WRAP_SLACK_SECONDS * ticksPerSecond) {
+            wraps++;
+        } else {
+            Reset(); // the sample is unwrapped again below, on the new base
+        }
+    }
+    haveLastRaw = true;
+    lastRaw = ticks;
+    lastRawHostNs = hostNs;
+    return (wraps << 32) + ticks;
+}
+
+void ClockSync::AddPair(qint64 deviceTicks, qint64 hostNs)
+{
+    pairTicks[next] = deviceTicks;
+    pairHostNs[next] = hostNs;
+    next = (next + 1) % window;
+    if (count < window) {
+        count++;
+    }
+
+    if (count == 1) {
+        refTicks = deviceTicks;
+        refHostNs = hostNs;
+        return;
+    }
+    if (count < window || ++sinceFit >= REFIT_INTERVAL) {
+        Fit();
+    }
+}
+
+void ClockSync::Fit()
+{
+    sinceFit = 0;
+
+    /* work relative to the newest pair so the sums stay small enough for doubles */
+    int newest = (next + window - 1) % window;
+    qint64 x0 = pairTicks[newest];
+    qint64 y0 = pairHostNs[newest];
+
+    double meanX = 0, meanY = 0;
+    for (int i = 0; i < count; i++) {
+        meanX += double(pairTicks[i] - x0);
+        meanY += double(pairHostNs[i] - y0);
+    }
+    meanX /= count;
+    meanY /= count;
+
+    double sxx = 0, sxy = 0;
+    for (int i = 0; i < count; i++) {
+        double dx = double(pairTicks[i] - x0) - meanX;
+        double dy = double(pairHostNs[i] - y0) - meanY;
+        sxx += dx * dx;
+        sxy += dx * dy;
+    }
+    if (sxx <= 0) {
+        return; // all pairs share one tick value
+    }
+
+    double slope = sxy / sxx;
+    double nominal = 1e9 / ticksPerSecond;
+    if (slope < nominal * 0.9 || slope > nominal * 1.1) {
+        slope = nominal; // a burst of delayed arrivals, not a real 10% clock error
+    }
+    double intercept = meanY - slope * meanX;
+
+    /* lower the line onto the pair with the least transport delay */
+    double minResidual = std::numeric_limits<double>::max();
+    for (int i = 0; i < count; i++) {
+        double residual = double(pairHostNs[i] - y0) - (intercept + slope * double(pairTicks[i] - x0));
+        minResidual = qMin(minResidual, residual);
+    }
+
+    nsPerTick = slope;
+    refTicks = x0;
+    refHostNs = y0 + qint64(intercept + minResidual);
+}
+
+double ClockSync::ToHostSeconds(qint64 deviceTicks) const
+{
+    return (refHostNs + nsPerTick * double(deviceTicks - refTicks)) / 1e9;
+}
+
+double ClockSync::DriftPpm() const
+{
+    double nominal = 1e9 / ticksPerSecond;
+    return (nsPerTick - nominal) / nominal * 1e6;
+}
@@ -0,0 +1,48 @@
+#ifndef CLOCKSYNC_H
+#define CLOCKSYNC_H
+
+#include <QVector>
+
+/*
+ * Maps a device's free running tick counter to HostClock time.
+ * Every received timestamp gives a (device ticks, host ns at arrival) pair; a least squares
+ * line through the last 'window' pairs gives drift and offset. Arrival is always later than
+ * the sample, so the line is then lowered onto the fastest observed pair, leaving only the
+ * minimum transport latency as error instead of the average one.
+ */
+class ClockSync {
+public:
+    explicit ClockSync(double ticksPerSecond, int window);
+
+    void Reset();
+    qint64 Unwrap(quint32 ticks, qint64 hostNs); // extends a wrapping 32 bit counter (micros() wraps every ~71 min), resets on a device reset
+    void AddPair(qint64 deviceTicks, qint64 hostNs); // deviceTicks as returned by Unwrap
+    double ToHostSeconds(qint64 deviceTicks) const;
+
+    bool IsSynced() const { return count >= 2; }
+    double DriftPpm() const; // device clock error relative to the host
+
+private:
+    double ticksPerSecond;
+    int window;
+
+    QVector<qint64> pairTicks;
+    QVector<qint64> pairHostNs;
+    int next = 0;
+    int count = 0;
+    int sinceFit = 0;
+
+    /* fitted line: hostNs = refHostNs + nsPerTick * (ticks - refTicks) */
+    qint64 refTicks = 0;
+    qint64 refHostNs = 0;
+    double nsPerTick;
+
+    bool haveLastRaw = false;
+    quint32 lastRaw = 0;
+    qint64 lastRawHostNs = 0;
+    qint64 wraps = 0;
+
+    void Fit();
+};
+
+#endif // CLOCKSYNC_H
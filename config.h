@@ -3,8 +3,39 @@
 
 //------------------------- PROJECT CONFIG ------------------//
 
-//#define USE_OPENGL
+//#define USE_OPENGL // render into OpenGL frame buffers and draw the graph lines from vertex buffers on the GPU
 #define HIGH_PERF
+#define PARALLEL_REPLOT // render the plots on the thread pool into QImage paint buffers, not with USE_OPENGL
+#define TARGET_FPS 0 // plot refresh rate, 0 follows the refresh rate of the primary screen
+//#define AUTOSCALE_VALUE_AXIS // fit the y axes to the visible samples every frame instead of the fixed default ranges
+
+#define SAMPLE_RING_CAPACITY 65536 // samples buffered between the serial thread and the gui
+//#define BATCHED_DELIVERY // one SampleBatch signal per serial read instead of the sample ring
+#define MAX_LINE_LENGTH 1024 // longer text lines are dropped and counted as truncated
+#define PLOT_HISTORY_CAPACITY 200000 // samples kept per graph, older ones are dropped
+
+#define MAX_SOURCES 4 // serial ports that can be connected at the same time, each on its own thread
+#define CHANNELS_PER_SOURCE 256 // channel ids of source n are n * CHANNELS_PER_SOURCE + device channel
+#define PRIMARY_SOURCE 0 // the PID controller: its channels feed the PID plots and it receives the commands
+
+//------------------------- SESSION RECORDING -------------//
+// See sessionformat.h for the file layout
+#define SESSION_CHUNK_SAMPLE_COUNT 4096 // samples of one channel per chunk
+#define SESSION_RAW_CHUNK_BYTES 65536 // raw port bytes per chunk
+#define SESSION_FLUSH_INTERVAL 1.0 // seconds a partly filled chunk may wait; bounds what a crash can lose
+#define SESSION_INDEX_INTERVAL 256 // chunks between two index chunks
+#define SESSION_MAX_QUEUED_BYTES (64 * 1024 * 1024) // chunks beyond this wait for a slow disk are dropped
+//#define SESSION_RECORD_RAW // also record the bytes as read from the ports, not just the decoded samples
+#define SESSION_FILE_SUFFIX "ardsession"
+#define REPLAY_TICK_MS 5 // how often a replay pushes the samples that became due
+#define REPLAY_FAST_STEP 0.25 // session seconds per step when replaying as fast as possible
+
+//------------------------- SPECTRUM ----------------------//
+#define SPECTRUM_FFT_SIZE 256 // samples per transform, rounded up to a power of two; the waterfall has FFT_SIZE / 2 + 1 rows
+#define SPECTRUM_HOP 8 // samples between two columns, at 1 kHz that is 125 columns per second
+#define SPECTRUM_COLUMNS 1000 // columns kept in the waterfall, older ones scroll out
+#define SPECTRUM_DYNAMIC_RANGE_DB 80 // the color scale spans this far below the strongest bin of the first spectrum
+#define SPECTRUM_RATE_TOLERANCE 0.05 // relative change of the estimated sample rate that restarts the waterfall
 
 //------------------------- RECEIVE COMMANDS ----------------//
 
@@ -38,6 +69,8 @@
 #define ARD_NORMAL_LOOP_TIME 20
 #define ARD_SERIAL_LOOP_TIME 21
 
+#define ARD_CHANNEL_INFO 22 // "<id>,<name>,<unit>,<scale>,<plot>,<color>", see ChannelRegistry
+
 //------------------------ FROM REMOTE ----------------------//
 #define REMOTE_X_DATA 100
 #define REMOTE_Y_DATA 101
@@ -81,7 +114,36 @@
 #define CUTE_CYCLE_TIME_PRINTS_ON 32
 #define CUTE_CYCLE_TIME_PRINTS_OFF 33
 
+#define CUTE_BINARY_FRAMES_ON 34
+#define CUTE_BINARY_FRAMES_OFF 35
+#define CUTE_GET_CHANNEL_INFO 36 // device answers with one ARD_CHANNEL_INFO per channel it sends
+
+//------------------------- BINARY FRAMES -----------------//
+// Frame layout (multi-byte fields little endian):
+// [SYNC][channel][format][count][payload: count samples][CRC16 lo][CRC16 hi]
+// The CRC16 (CCITT, init 0xFFFF) covers channel, format, count and payload.
+#define FRAME_SYNC 0xA5
+#define FRAME_HEADER_SIZE 4
+#define FRAME_CRC_SIZE 2
+
+#define FRAME_FMT_FLOAT32 0
+#define FRAME_FMT_INT16 1
+#define FRAME_FMT_TEXT 2 // payload is 'count' bytes of log text
+
+// Format flag: the header is followed by [u32 ticks of the first sample][u16 ticks between samples]
+#define FRAME_FLAG_TIMESTAMP 0x80
+#define FRAME_TIMESTAMP_SIZE 6
+
+//------------------------- DEVICE TIMESTAMPS -------------//
+// Text lines may end in "@<ticks>", binary frames use FRAME_FLAG_TIMESTAMP
+#define LINE_TIMESTAMP_MARK '@'
+#define DEVICE_TICKS_PER_SECOND 1000000.0 // the device sends micros()
+#define CLOCK_SYNC_WINDOW 256 // timestamp pairs used to fit the device clock
+
 //------------------------- SCALING -----------------------//
+// Defaults of the built-in PID channels; CHANNEL_CONFIG_FILE and device announcements override them
+#define CHANNEL_CONFIG_FILE "channels.ini" // looked up next to the executable
+
 #define SCALE_PID1_INPUT 40
 #define SCALE_PID1_OUTPUT 255
 #define SCALE_PID1_SETPOINT 40
@@ -0,0 +1,68 @@
+#include "framescheduler.h"
+
+#include <QGuiApplication>
+#include <QScreen>
+#include <QtMath>
+
+#include "hostclock.h"
+
+FrameScheduler::FrameScheduler(QObject* parent)
+    : QObject(parent)
+{
+    timer.setTimerType(Qt::PreciseTimer); // the default coarse timer jitters by 5%, a visible stutter at 60 Hz
+    connect(&timer, SIGNAL(timeout()), this, SLOT(Tick()));
+    UpdateInterval();
+}
+
+void FrameScheduler::SetTargetFps(double fps)
+{
+    targetFps = fps;
+    UpdateInterval();
+}
+
+void FrameScheduler::Start()
+{
+    UpdateInterval();
+    ticksToSkip = 0;
+    timer.start();
+}
+
+void FrameScheduler::Stop()
+{
+    timer.stop();
+}
+
+void FrameScheduler::UpdateInterval()
+{
+    double fps = targetFps;
+    if (fps <= 0) {
+        QScreen* screen = QGuiApplication::primaryScreen();
+        fps = (screen != nullptr && screen->refreshRate() > 0) ? screen->refreshRate() : 60;
+    }
+    frameInterval = 1.0 / fps;
+    timer.setInterval(qMax(1, qRound(frameInterval * 1000)));
+}
+
+void FrameScheduler::Tick()
+{
+    emit Poll();
+
+    if (ticksToSkip > 0) { // still paying for the last overrun
+        ticksToSkip--;
+        if (framePending) {
+            skippedFrames++;
+        }
+        return;
+    }
+    if (!framePending) {
+        return;
+    }
+
+    framePending = false;
+    double start = HostClock::Seconds();
+    emit Render();
+    double renderTime = HostClock::Seconds() - start;
+    if (renderTime > frameInterval) {
+        ticksToSkip = qMin(qFloor(renderTime / frameInterval), 10);
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+
+/*
+ * Paces rendering to the display instead of replotting as fast as the event loop spins.
+ * Every tick emits Poll() so new data can be collected; Render() follows only if something
+ * requested a frame since the last one. A render that takes longer than a frame period makes
+ * the scheduler skip the ticks it overran, so a slow replot can't queue up behind itself.
+ */
+class FrameScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    explicit FrameScheduler(QObject* parent = nullptr);
+
+    void SetTargetFps(double fps); // 0 follows the refresh rate of the primary screen
+    double FrameInterval() const { return frameInterval; } // seconds
+    void Start();
+    void Stop();
+    void RequestFrame() { framePending = true; } // new data or a changed view, render on the next tick
+    quint64 SkippedFrames() const { return skippedFrames; }
+
+signals:
+    void Poll();
+    void Render();
+
+private slots:
+    void Tick();
+
+private:
+    QTimer timer;
+    double targetFps = 0;
+    double frameInterval = 1.0 / 60;
+    bool framePending = false;
+    int ticksToSkip = 0;
+    quint64 skippedFrames = 0;
+
+    void UpdateInterval();
+};
+
+#endif // FRAMESCHEDULER_H
@@ -0,0 +1,26 @@
+#-------------------------------------------------
+#
+# Smoke check of the OpenGL line renderer (QCPGlLineRenderer), runs headless:
+#   qmake && make && QT_QPA_PLATFORM=offscreen LIBGL_ALWAYS_SOFTWARE=1 ./glsmoke
+# Exits with 0 if the graphs drawn from vertex buffers match the QPainter ones.
+#
+#-------------------------------------------------
+
+QT       += core gui printsupport widgets
+
+TARGET = glsmoke
+TEMPLATE = app
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+DEFINES += QCUSTOMPLOT_USE_OPENGL
+
+INCLUDEPATH += ..
+
+SOURCES += \
+        main.cpp \
+    ../qcustomplot.cpp
+
+HEADERS += \
+    ../qcustomplot.h
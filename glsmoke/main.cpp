@@ -0,0 +1,148 @@
+#include "qcustomplot.h"
+
+#include <QApplication>
+#include <cmath>
+#include <cstdio>
+
+/*
+ * Draws the same graphs once from the vertex buffers of QCPGlLineRenderer and once with QPainter
+ * into the OpenGL frame buffers of a hidden plot, and compares the line pixels of both frames.
+ * Meant for a software OpenGL like Mesa's llvmpipe on a headless machine, see glsmoke.pro.
+ */
+
+/* Gives the checks access to the plot's line renderer */
+class SmokePlot : public QCustomPlot {
+public:
+    QCPGlLineRenderer* Renderer() const { return mGlLineRenderer; }
+};
+
+/* Draws through the line renderer directly, so a check can tell whether it took the OpenGL path */
+class SmokeGraph : public QCPGraph {
+public:
+    SmokeGraph(QCPAxis* keyAxis, QCPAxis* valueAxis)
+        : QCPGraph(keyAxis, valueAxis)
+    {
+    }
+
+    bool useGl = true;
+    bool drawnByGl = false; // by the last replot
+
+protected:
+    void draw(QCPPainter* painter) override
+    {
+        QCPGlLineRenderer* renderer = static_cast<SmokePlot*>(mParentPlot)->Renderer();
+        drawnByGl = useGl && renderer != nullptr && renderer->drawGraph(painter, this);
+        if (!drawnByGl) {
+            QCPGraph::draw(painter);
+        }
+    }
+};
+
+static int failures = 0;
+
+static void Check(bool ok, const char* what)
+{
+    std::printf("%s: %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok) {
+        failures++;
+    }
+}
+
+static bool IsLine(QRgb pixel)
+{
+    return qBlue(pixel) - qRed(pixel) > 100; // blue pen on white
+}
+
+/* Fraction of the line pixels of a that have a line pixel of b within 2 pixels */
+static double Matched(const QImage& a, const QImage& b, int* lines)
+{
+    int matched = 0;
+    *lines = 0;
+    for (int y = 0; y < a.height(); y++) {
+        for (int x = 0; x < a.width(); x++) {
+            if (!IsLine(a.pixel(x, y))) {
+                continue;
+            }
+            (*lines)++;
+            bool found = false;
+            for (int dy = -2; dy <= 2 && !found; dy++) {
+                for (int dx = -2; dx <= 2 && !found; dx++) {
+                    found = b.valid(x + dx, y + dy) && IsLine(b.pixel(x + dx, y + dy));
+                }
+            }
+            matched += found ? 1 : 0;
+        }
+    }
+    return *lines > 0 ? double(matched) / *lines : 0;
+}
+
+static QImage Render(SmokePlot* plot, SmokeGraph* graph, bool useGl)
+{
+    graph->useGl = useGl;
+    plot->replot();
+    return plot->grab().toImage().convertToFormat(QImage::Format_RGB32);
+}
+
+/* Renders the plot both ways and checks that the OpenGL path was taken and matches QPainter */
+static void CompareFrames(SmokePlot* plot, SmokeGraph* graph, const char* what)
+{
+    const QImage gl = Render(plot, graph, true);
+    const bool drawnByGl = graph->drawnByGl;
+    const QImage reference = Render(plot, graph, false);
+    int glLines, referenceLines;
+    const double glMatched = Matched(gl, reference, &glLines);
+    const double referenceMatched = Matched(reference, gl, &referenceLines);
+    std::printf("      %s: %d/%d line pixels, %.1f%%/%.1f%% matched\n", what, glLines, referenceLines, glMatched * 100, referenceMatched * 100);
+    Check(drawnByGl, QString("%1 is drawn from the vertex buffer").arg(what).toUtf8().constData());
+    Check(glLines > 100 && glMatched > 0.98 && referenceMatched > 0.98, QString("%1 matches QPainter").arg(what).toUtf8().constData());
+}
+
+int main(int argc, char* argv[])
+{
+    QApplication a(argc, argv);
+
+    SmokePlot plot;
+    plot.resize(600, 400);
+    plot.show(); // offscreen, but the plot only takes its size from a delivered resize event
+    a.processEvents();
+    plot.setOpenGl(true, 0);
+    if (!plot.openGl() || plot.Renderer() == nullptr || !plot.Renderer()->isValid()) {
+        std::printf("FAIL: no OpenGL context or line renderer\n");
+        return 1;
+    }
+    plot.setPlottingHint(QCP::phGlLines, true);
+
+    SmokeGraph* graph = new SmokeGraph(plot.xAxis, plot.yAxis);
+    graph->setPen(QPen(Qt::blue));
+    graph->setAdaptiveSampling(false); // the vertex buffer holds every data point
+    plot.yAxis->setRange(-1.2, 1.2);
+
+    QVector<double> keys, values;
+    for (int i = 0; i < 2000; i++) {
+        keys.append(i);
+        values.append(std::sin(i * 0.02));
+    }
+    graph->addData(keys, values, true);
+    plot.xAxis->setRange(0, 2000);
+    CompareFrames(&plot, graph, "appended data");
+
+    // a NaN in view leaves the graph to QPainter, once it is scrolled out of the capacity the vertex buffer is used again
+    graph->data()->setCapacity(1000);
+    graph->addData(2000, qQNaN());
+    plot.xAxis->setRange(1001, 2000);
+    Render(&plot, graph, true);
+    Check(!graph->drawnByGl, "a visible NaN is left to QPainter");
+
+    keys.resize(0);
+    values.resize(0);
+    for (int i = 2001; i < 4000; i++) { // enough to push the NaN out and grow the vertex buffer
+        keys.append(i);
+        values.append(std::sin(i * 0.02));
+    }
+    graph->addData(keys, values, true);
+    plot.xAxis->setRange(3001, 4000);
+    CompareFrames(&plot, graph, "data after a NaN scrolled out");
+
+    std::printf("%s\n", failures == 0 ? "passed" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,13 @@
+#include "hostclock.h"
+
+#include <QElapsedTimer>
+
+qint64 HostClock::Nanoseconds()
+{
+    static QElapsedTimer timer = [] {
+        QElapsedTimer t;
+        t.start();
+        return t;
+    }();
+    return timer.nsecsElapsed();
+}
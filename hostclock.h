@@ -0,0 +1,15 @@
+#ifndef HOSTCLOCK_H
+#define HOSTCLOCK_H
+
+#include <QtGlobal>
+
+/*
+ * Monotonic process-wide clock shared by the serial threads and the gui, so sample
+ * timestamps and the plot's time axis have the same epoch.
+ */
+namespace HostClock {
+qint64 Nanoseconds(); // since the first call, never goes backwards
+inline double Seconds() { return Nanoseconds() / 1e9; }
+}
+
+#endif // HOSTCLOCK_H
@@ -0,0 +1,129 @@
+#include "lineparser.h"
+
+#if defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+
+LineParser::LineParser(LinkStats* stats, int maxLineLength)
+    : stats(stats)
+    , maxLineLength(maxLineLength)
+{
+    partial.reserve(maxLineLength);
+}
+
+void LineParser::Reset()
+{
+    partial.resize(0);
+    overflow = false;
+}
+
+void LineParser::Keep(const char* begin, const char* end)
+{
+    if (overflow) {
+        return;
+    }
+    if (partial.size() + (end - begin) > maxLineLength) {
+        overflow = true;
+        partial.resize(0);
+        return;
+    }
+    partial.append(begin, int(end - begin));
+}
+
+bool LineParser::IsBlank(const char* begin, const char* end)
+{
+    for (; begin < end; begin++) {
+        if (*begin != ' ' && *begin != '\t' && *begin != '\r') {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool LineParser::ParseDouble(const char* begin, const char* end, double* value, const char** next)
+{
+    while (begin < end && (*begin == ' ' || *begin == '\t')) {
+        begin++;
+    }
+    if (begin < end && *begin == '+') { // from_chars doesn't accept an explicit plus
+        begin++;
+    }
+
+#if defined(__cpp_lib_to_chars)
+    std::from_chars_result result = std::from_chars(begin, end, *value);
+    if (result.ec != std::errc()) {
+        return false;
+    }
+    *next = result.ptr;
+    return true;
+#else
+    /* Fallback for standard libraries without floating point from_chars */
+    static const double powersOf10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+        1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+    const char* pos = begin;
+    bool negative = false;
+    if (pos < end && *pos == '-') {
+        negative = true;
+        pos++;
+    }
+
+    quint64 mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    for (; pos < end && *pos >= '0' && *pos <= '9'; pos++, digits++) {
+        if (mantissa < 100000000000000000ULL) {
+            mantissa = mantissa * 10 + (*pos - '0');
+        } else {
+            exponent++; // digits beyond double precision
+        }
+    }
+    if (pos < end && *pos == '.') {
+        for (pos++; pos < end && *pos >= '0' && *pos <= '9'; pos++, digits++) {
+            if (mantissa < 100000000000000000ULL) {
+                mantissa = mantissa * 10 + (*pos - '0');
+                exponent--;
+            }
+        }
+    }
+    if (digits == 0) {
+        return false;
+    }
+
+    if (pos < end && (*pos == 'e' || *pos == 'E')) {
+        const char* expPos = pos + 1;
+        bool expNegative = false;
+        if (expPos < end && (*expPos == '-' || *expPos == '+')) {
+            expNegative = (*expPos == '-');
+            expPos++;
+        }
+        if (expPos < end && *expPos >= '0' && *expPos <= '9') { // otherwise the 'e' isn't part of the number
+            int exp = 0;
+            for (; expPos < end && *expPos >= '0' && *expPos <= '9'; expPos++) {
+                if (exp < 10000) {
+                    exp = exp * 10 + (*expPos - '0');
+                }
+            }
+            exponent += expNegative ? -exp : exp;
+            pos = expPos;
+        }
+    }
+
+    double result = double(mantissa);
+    while (exponent > 22) {
+        result *= 1e22;
+        exponent -= 22;
+    }
+    while (exponent < -22) {
+        result /= 1e22;
+        exponent += 22;
+    }
+    result = exponent < 0 ? result / powersOf10[-exponent] : result * powersOf10[exponent];
+
+    *value = negative ? -result : result;
+    *next = pos;
+    return true;
+#endif
+}
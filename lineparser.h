@@ -0,0 +1,70 @@
+#ifndef LINEPARSER_H
+#define LINEPARSER_H
+
+#include <QByteArray>
+#include <cstring>
+
+#include "linkstats.h"
+
+/*
+ * Splits a byte stream into '\n' terminated lines without copying them: lines that are
+ * complete inside a chunk are handed out in place, only a line spanning two chunks is
+ * assembled in a reusable buffer. Lines longer than maxLineLength are dropped whole and
+ * counted as truncated instead of being split.
+ */
+class LineParser {
+public:
+    explicit LineParser(LinkStats* stats, int maxLineLength);
+
+    // calls onLine(const char* begin, const char* end) for every complete line, '\n' excluded
+    template <typename F>
+    void Feed(const char* data, int size, F onLine);
+    void Reset();
+
+    // locale independent; skips leading blanks and '+', returns false if no number was found
+    static bool ParseDouble(const char* begin, const char* end, double* value, const char** next);
+    static bool IsBlank(const char* begin, const char* end);
+
+private:
+    LinkStats* stats;
+    int maxLineLength;
+    QByteArray partial; // start of a line whose end hasn't arrived yet
+    bool overflow = false; // partial line already exceeded maxLineLength
+
+    void Keep(const char* begin, const char* end);
+};
+
+template <typename F>
+void LineParser::Feed(const char* data, int size, F onLine)
+{
+    const char* pos = data;
+    const char* end = data + size;
+
+    while (pos < end) {
+        const char* newline = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+        if (newline == nullptr) {
+            Keep(pos, end);
+            return;
+        }
+
+        if (partial.isEmpty() && !overflow) {
+            if (newline - pos > maxLineLength) {
+                Count(stats->truncated);
+            } else {
+                onLine(pos, newline);
+            }
+        } else {
+            Keep(pos, newline);
+            if (overflow) {
+                Count(stats->truncated);
+            } else {
+                onLine(partial.constData(), partial.constData() + partial.size());
+            }
+            partial.resize(0); // keeps the reserved capacity
+            overflow = false;
+        }
+        pos = newline + 1;
+    }
+}
+
+#endif // LINEPARSER_H
@@ -0,0 +1,23 @@
+#ifndef LINKSTATS_H
+#define LINKSTATS_H
+
+#include <QtGlobal>
+#include <atomic>
+
+/*
+ * Health counters of one serial link. Written only by the serial thread, read by the gui,
+ * so plain relaxed stores are enough (see Count).
+ */
+struct LinkStats {
+    std::atomic<quint64> samples { 0 }; // decoded and forwarded
+    std::atomic<quint64> malformed { 0 }; // unparsable lines, binary frames failing the crc
+    std::atomic<quint64> truncated { 0 }; // lines longer than MAX_LINE_LENGTH, dropped
+    std::atomic<quint64> discarded { 0 }; // parsed but out of range (glitches)
+};
+
+inline void Count(std::atomic<quint64>& counter, quint64 n = 1)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+#endif // LINKSTATS_H
@@ -1,7 +1,13 @@
 #include "mainwindow.h"
 #include "config.h"
+#include "hostclock.h"
+#include "recordingviewer.h"
 #include "ui_mainwindow.h"
 
+#include <QFileDialog>
+#include <QInputDialog>
+#include <QtConcurrent>
+
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
@@ -10,60 +16,114 @@ MainWindow::MainWindow(QWidget* parent)
 
     ConfigureConnectionControls(); //configure the connection ui: ports, baud rate, etc
     EnableControls(true);
+    EnablePidControls(false);
+
+    drainBuffer.resize(4096);
+    LoadChannelRegistry();
+    recorder = new SessionRecorder(this);
+    CreateSerialWorkers(); // create the serial worker threads
 
-    CreateSerialWorker(); // create the serial worker thread
+    replayer = new SessionReplayer;
+    replayThread = new QThread;
+    replayer->moveToThread(replayThread);
+    connect(replayer, &SessionReplayer::opened, this, &MainWindow::ReplayOpened);
+    connect(replayer, &SessionReplayer::openFailed, this, &MainWindow::ReplayOpenFailed);
+    connect(replayer, &SessionReplayer::finished, this, &MainWindow::ReplayFinished);
+    replayThread->start();
 
     timeTicker = QSharedPointer<QCPAxisTickerTime>(new QCPAxisTickerTime);
     timeTicker->setTimeFormat("%h:%m:%s");
 
-    //configure the plots; add 3 lines (pid input, setpoint, output) for each; configure colors
-    ConfigurePidPlot(ui->customPlotPid1);
-    ConfigurePidPlot(ui->customPlotPid2);
-    ConfigurePidPlot(ui->customPlotPid3);
+    //configure the plots; the lines (pid input, setpoint, output, ...) and their colors come from the channel registry
+    plots = { ui->customPlotPid1, ui->customPlotPid2, ui->customPlotPid3 };
+    plotRefresh.resize(plots.size());
+    for (QCustomPlot* plot : plots) {
+        ConfigurePidPlot(plot);
+    }
+    for (int id = 0; id < channelRegistry.Size(); id++) {
+        GraphForChannel(id); // create the known graphs up front so the legends are complete
+    }
 
     SetPidDefaultRanges(false);
 
-    // setup a timer that repeatedly calls MainWindow::realtimeDataSlot:
-    QTimer* dataTimer = new QTimer(this);
-    connect(dataTimer, SIGNAL(timeout()), this, SLOT(RealTimeDataSlot()));
-    dataTimer->start(0); // Interval 0 means to refresh as fast as possible
+    // once per display refresh the scheduler polls the new samples (PollData) and, if any plot
+    // changed, renders a frame (RenderFrame):
+    frameScheduler = new FrameScheduler(this);
+    frameScheduler->SetTargetFps(TARGET_FPS);
+    connect(frameScheduler, SIGNAL(Poll()), this, SLOT(PollData()));
+    connect(frameScheduler, SIGNAL(Render()), this, SLOT(RenderFrame()));
+    frameScheduler->Start();
 
     ui->doubleSpinBoxSecondsToPlot->setValue(SecondsToPlot);
 }
 
 MainWindow::~MainWindow()
 {
-    emit requestDisconnect();
-    serialWorkerThread.terminate();
-    serialWorkerThread.wait();
+    for (SerialSource& source : sources) {
+        disconnect(source.worker, nullptr, this, nullptr);
+        QMetaObject::invokeMethod(source.worker, "PortDisconnect", Qt::BlockingQueuedConnection);
+        source.thread->quit();
+        source.thread->wait();
+        delete source.worker;
+        delete source.thread;
+    }
+    recorder->Stop(); // no source feeds it anymore, write the rest and close the file
+    QMetaObject::invokeMethod(replayer, "Close", Qt::BlockingQueuedConnection);
+    replayThread->quit();
+    replayThread->wait();
+    delete replayer;
+    delete replayThread;
     delete ui;
 }
 
 void MainWindow::SetPidDefaultRanges(bool normalized)
 {
-    if (normalized) {
-        ui->customPlotPid1->yAxis->setRange(-1.2, 1.2);
-        ui->customPlotPid2->yAxis->setRange(-1.2, 1.2);
-        ui->customPlotPid3->yAxis->setRange(-1.2, 1.2);
-    } else {
-        //Configure default ranges
-        QVector<double> a = { SCALE_PID1_INPUT, SCALE_PID1_OUTPUT, SCALE_PID1_SETPOINT };
-        double maxP1 = *(std::max_element(a.begin(), a.end()));
-        ui->customPlotPid1->yAxis->setRange(-(maxP1 + maxP1 * 0.1), (maxP1 + maxP1 * 0.1));
+    for (int p = 0; p < plots.size(); p++) {
+        if (normalized) {
+            plots[p]->yAxis->setRange(-1.2, 1.2);
+            continue;
+        }
 
-        QVector<double> b = { SCALE_PID2_INPUT, SCALE_PID2_OUTPUT, SCALE_PID2_SETPOINT };
-        double maxP2 = *(std::max_element(b.begin(), b.end()));
-        ui->customPlotPid2->yAxis->setRange(-(maxP2 + maxP2 * 0.1), (maxP2 + maxP2 * 0.1));
+        //Configure default ranges from the largest full scale value shown in the plot
+        double maxScale = 0;
+        for (int id = 0; id < channelRegistry.Size(); id++) {
+            const ChannelInfo& info = channelRegistry.Info(id);
+            if (info.IsValid() && info.plot == p) {
+                maxScale = qMax(maxScale, qAbs(info.scale));
+            }
+        }
+        if (maxScale > 0) {
+            plots[p]->yAxis->setRange(-(maxScale + maxScale * 0.1), (maxScale + maxScale * 0.1));
+        }
+    }
+}
+
+void MainWindow::LoadChannelRegistry()
+{
+    channelRegistry.LoadDefaults();
 
-        QVector<double> c = { SCALE_PID3_INPUT, SCALE_PID3_OUTPUT, SCALE_PID3_SETPOINT };
-        double maxP3 = *(std::max_element(c.begin(), c.end()));
-        ui->customPlotPid3->yAxis->setRange(-(maxP3 + maxP3 * 0.1), (maxP3 + maxP3 * 0.1));
+    QString fileName = QCoreApplication::applicationDirPath() + "/" + CHANNEL_CONFIG_FILE;
+    if (QFile::exists(fileName)) {
+        channelRegistry.LoadFile(fileName);
     }
+
+    channelBuffers.resize(channelRegistry.Size());
+    channelGraphs.fill(nullptr, channelRegistry.Size());
 }
 
 //--------------------------- Ui and buttons ------------------------------------------------------//
 void MainWindow::ConfigureConnectionControls()
 {
+    /* One entry per serial source; the first one is the PID controller */
+    for (int i = 0; i < MAX_SOURCES; i++) {
+        ui->comboSource->addItem(i == PRIMARY_SOURCE ? QString("%1 (PID)").arg(i + 1) : QString::number(i + 1));
+    }
+
+    /* Replay speeds; replay works without any port, so these come before the port check */
+    for (const char* speed : { "1x", "2x", "5x", "10x", "100x", "Max" }) {
+        ui->comboReplaySpeed->addItem(speed);
+    }
+
     /* Check if there are any ports at all; if not, disable controls and return */
     if (QSerialPortInfo::availablePorts().size() == 0) {
         //  enable_com_controls (false);
@@ -112,42 +172,76 @@ void MainWindow::ConfigureConnectionControls()
     ui->comboStop->addItem("2 bits");
 }
 
-void MainWindow::CreateSerialWorker()
+void MainWindow::CreateSerialWorkers()
 {
-    serialWorker = new SerialWorker;
-    serialWorker->moveToThread(&serialWorkerThread);
+#ifdef BATCHED_DELIVERY
+    qRegisterMetaType<SampleBatchPtr>();
+#endif
 
-    //this -> serialWorker
-    connect(this, &MainWindow::requestConnect, serialWorker, &SerialWorker::PortConnect);
-    connect(this, &MainWindow::requestDisconnect, serialWorker, &SerialWorker::PortDisconnect);
-    connect(this, &MainWindow::requestSendData, serialWorker, &SerialWorker::PortSendData);
+    qRegisterMetaType<ChannelInfo>();
 
-    //serialWorker -> this
-    //qRegisterMetaType<QHash<int,QVector<double>>>("QHash<int,QVector<double>>");
-    connect(serialWorker, &SerialWorker::ForwardReceivedDataDouble, this, &MainWindow::ReceiveDataDoubleFromWroker);
-    connect(serialWorker, &SerialWorker::portOpenOK, this, &MainWindow::serialConnectOk);
-    connect(serialWorker, &SerialWorker::portOpenFail, this, &MainWindow::serialConnectFailed);
-    connect(serialWorker, &SerialWorker::portClosed, this, &MainWindow::serialPortClosed);
+    sources.resize(MAX_SOURCES);
+    for (int i = 0; i < sources.size(); i++) {
+        SerialWorker* serialWorker = new SerialWorker;
+        serialWorker->SetChannelBase(i * CHANNELS_PER_SOURCE);
+        serialWorker->SetRecorder(recorder);
 
-    serialWorkerThread.start();
+        //serialWorker -> this
+#ifdef BATCHED_DELIVERY
+        serialWorker->SetBatchDelivery(true);
+        connect(serialWorker, &SerialWorker::ForwardSampleBatch, this, &MainWindow::ReceiveSampleBatch);
+#endif
+        //otherwise samples don't go through signals; PollData drains every worker's SampleRing()
+        connect(serialWorker, &SerialWorker::portOpenOK, this, [this, i] { serialConnectOk(i); });
+        connect(serialWorker, &SerialWorker::portOpenFail, this, [this, i] { serialConnectFailed(i); });
+        connect(serialWorker, &SerialWorker::portClosed, this, [this, i] { serialPortClosed(i); });
+        connect(serialWorker, &SerialWorker::channelAnnounced, this, &MainWindow::ChannelAnnounced);
+
+        //this -> serialWorker goes through QMetaObject::invokeMethod, so every request reaches only its own port
+        sources[i].worker = serialWorker;
+        sources[i].thread = new QThread;
+        serialWorker->moveToThread(sources[i].thread);
+        sources[i].thread->start();
+    }
 }
 
-void MainWindow::serialConnectOk()
+int MainWindow::SelectedSource() const
 {
-    EnableControls(false);
-    Connected = true;
-    SendCommand(CUTE_GET_ALL_PID_CFGS);
+    return qMax(ui->comboSource->currentIndex(), 0);
 }
-void MainWindow::serialConnectFailed()
+
+void MainWindow::SetSourceConnected(int source, bool connected)
 {
-    EnableControls(true);
+    sources[source].connected = connected;
+
     Connected = false;
+    for (const SerialSource& s : sources) {
+        Connected = Connected || s.connected;
+    }
+
+    if (source == SelectedSource()) {
+        EnableControls(!connected);
+    }
+    if (source == PRIMARY_SOURCE) {
+        EnablePidControls(connected);
+    }
 }
 
-void MainWindow::serialPortClosed()
+void MainWindow::serialConnectOk(int source)
 {
-    EnableControls(true);
-    Connected = false;
+    SetSourceConnected(source, true);
+    if (source == PRIMARY_SOURCE) {
+        SendCommand(CUTE_GET_ALL_PID_CFGS);
+    }
+}
+void MainWindow::serialConnectFailed(int source)
+{
+    SetSourceConnected(source, false);
+}
+
+void MainWindow::serialPortClosed(int source)
+{
+    SetSourceConnected(source, false);
 }
 
 void MainWindow::EnableControls(bool enable)
@@ -158,29 +252,33 @@ void MainWindow::EnableControls(bool enable)
     ui->comboParity->setEnabled(enable);
     ui->comboPort->setEnabled(enable);
     ui->comboStop->setEnabled(enable);
+    ui->checkBoxBinaryFrames->setEnabled(enable);
     ui->pushButtonConnect->setEnabled(enable);
 
     ui->pushButtonDisconnect->setEnabled(!enable);
+}
 
-    ui->doubleSpinBoxP1Kp->setEnabled(!enable);
-    ui->doubleSpinBoxP1Ki->setEnabled(!enable);
-    ui->doubleSpinBoxP1Kd->setEnabled(!enable);
-    ui->doubleSpinBoxP1Setpoint->setEnabled(!enable);
-
-    ui->doubleSpinBoxP2Kp->setEnabled(!enable);
-    ui->doubleSpinBoxP2Ki->setEnabled(!enable);
-    ui->doubleSpinBoxP2Kd->setEnabled(!enable);
-    ui->doubleSpinBoxP2Setpoint->setEnabled(!enable);
-
-    ui->doubleSpinBoxP3Kp->setEnabled(!enable);
-    ui->doubleSpinBoxP3Ki->setEnabled(!enable);
-    ui->doubleSpinBoxP3Kd->setEnabled(!enable);
-    ui->doubleSpinBoxP3Setpoint->setEnabled(!enable);
-
-    ui->checkBoxGiroToMot->setEnabled(!enable);
-    ui->checkBoxP1Prints->setEnabled(!enable);
-    ui->checkBoxP2Prints->setEnabled(!enable);
-    ui->checkBoxP3Prints->setEnabled(!enable);
+void MainWindow::EnablePidControls(bool enable)
+{
+    ui->doubleSpinBoxP1Kp->setEnabled(enable);
+    ui->doubleSpinBoxP1Ki->setEnabled(enable);
+    ui->doubleSpinBoxP1Kd->setEnabled(enable);
+    ui->doubleSpinBoxP1Setpoint->setEnabled(enable);
+
+    ui->doubleSpinBoxP2Kp->setEnabled(enable);
+    ui->doubleSpinBoxP2Ki->setEnabled(enable);
+    ui->doubleSpinBoxP2Kd->setEnabled(enable);
+    ui->doubleSpinBoxP2Setpoint->setEnabled(enable);
+
+    ui->doubleSpinBoxP3Kp->setEnabled(enable);
+    ui->doubleSpinBoxP3Ki->setEnabled(enable);
+    ui->doubleSpinBoxP3Kd->setEnabled(enable);
+    ui->doubleSpinBoxP3Setpoint->setEnabled(enable);
+
+    ui->checkBoxGiroToMot->setEnabled(enable);
+    ui->checkBoxP1Prints->setEnabled(enable);
+    ui->checkBoxP2Prints->setEnabled(enable);
+    ui->checkBoxP3Prints->setEnabled(enable);
 }
 
 //---------------------------- PLOT STUFF ---------------------------------------------------//
@@ -189,6 +287,7 @@ void MainWindow::ConfigurePidPlot(QCustomPlot* plot)
 {
 #ifdef USE_OPENGL
     plot->setOpenGl(true);
+    plot->setPlottingHint(QCP::phGlLines, true); // lines are uploaded once and transformed by the gpu, see QCPGlLineRenderer
 #endif
 
 #ifdef HIGH_PERF
@@ -201,17 +300,14 @@ void MainWindow::ConfigurePidPlot(QCustomPlot* plot)
 
     plot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
 
-    plot->addGraph(); // red line
-    plot->graph(0)->setPen(QPen(Qt::red));
-    plot->graph(0)->setName("Input");
-
-    plot->addGraph(); // blue line
-    plot->graph(1)->setPen(QPen(Qt::blue));
-    plot->graph(1)->setName("Output");
+    // the graphs get their own paint buffer, so RenderFrame can scroll it instead of redrawing it
+    plot->layer("main")->setMode(QCPLayer::lmBuffered);
 
-    plot->addGraph(); // green line
-    plot->graph(2)->setPen(QPen(Qt::green));
-    plot->graph(2)->setName("Setpoint");
+#if defined(PARALLEL_REPLOT) && !defined(USE_OPENGL)
+    /* QImage paint buffers can be rendered outside the gui thread; the label cache holds pixmaps, which can't */
+    plot->setPlottingHint(QCP::phImageBuffers, true);
+    plot->setPlottingHint(QCP::phCacheLabels, false);
+#endif
 
     plot->legend->setVisible(true);
     plot->axisRect()->insetLayout()->setInsetAlignment(0, Qt::AlignLeft | Qt::AlignTop); // make legend align in top left corner or axis rect
@@ -283,171 +379,356 @@ void MainWindow::BlockSignals(bool enable)
 
 void MainWindow::UpdateComponentValues()
 {
+    double value;
 
     BlockSignals(true);
     //PID1
-    if (!receivedData[ARD_PID1_INPUT].isEmpty()) {
-        ui->lineEditP1Input->setText(QString::number(receivedData[ARD_PID1_INPUT].last()));
+    if (LatestValue(ARD_PID1_INPUT, &value)) {
+        ui->lineEditP1Input->setText(QString::number(value));
     }
-    if (!receivedData[ARD_PID1_OUTPUT].isEmpty()) {
-        ui->lineEditP1Output->setText(QString::number(receivedData[ARD_PID1_OUTPUT].last()));
+    if (LatestValue(ARD_PID1_OUTPUT, &value)) {
+        ui->lineEditP1Output->setText(QString::number(value));
     }
-    if (!receivedData[ARD_PID1_SETPOINT].isEmpty()) {
-        ui->doubleSpinBoxP1Setpoint->setValue(receivedData[ARD_PID1_SETPOINT].last());
+    if (LatestValue(ARD_PID1_SETPOINT, &value)) {
+        ui->doubleSpinBoxP1Setpoint->setValue(value);
     }
-    if (!receivedData[ARD_PID1_KP].isEmpty()) {
-        ui->doubleSpinBoxP1Kp->setValue(receivedData[ARD_PID1_KP].last());
+    if (LatestValue(ARD_PID1_KP, &value)) {
+        ui->doubleSpinBoxP1Kp->setValue(value);
     }
-    if (!receivedData[ARD_PID1_KI].isEmpty()) {
-        ui->doubleSpinBoxP1Ki->setValue(receivedData[ARD_PID1_KI].last());
+    if (LatestValue(ARD_PID1_KI, &value)) {
+        ui->doubleSpinBoxP1Ki->setValue(value);
     }
-    if (!receivedData[ARD_PID1_KD].isEmpty()) {
-        ui->doubleSpinBoxP1Kd->setValue(receivedData[ARD_PID1_KD].last());
+    if (LatestValue(ARD_PID1_KD, &value)) {
+        ui->doubleSpinBoxP1Kd->setValue(value);
     }
 
     //PID2
-    if (!receivedData[ARD_PID2_INPUT].isEmpty()) {
-        ui->lineEditP2Input->setText(QString::number(receivedData[ARD_PID2_INPUT].last()));
+    if (LatestValue(ARD_PID2_INPUT, &value)) {
+        ui->lineEditP2Input->setText(QString::number(value));
     }
-    if (!receivedData[ARD_PID2_OUTPUT].isEmpty()) {
-        ui->lineEditP2Output->setText(QString::number(receivedData[ARD_PID2_OUTPUT].last()));
+    if (LatestValue(ARD_PID2_OUTPUT, &value)) {
+        ui->lineEditP2Output->setText(QString::number(value));
     }
-    if (!receivedData[ARD_PID2_SETPOINT].isEmpty()) {
-        ui->doubleSpinBoxP2Setpoint->setValue(receivedData[ARD_PID2_SETPOINT].last());
+    if (LatestValue(ARD_PID2_SETPOINT, &value)) {
+        ui->doubleSpinBoxP2Setpoint->setValue(value);
     }
-    if (!receivedData[ARD_PID2_KP].isEmpty()) {
-        ui->doubleSpinBoxP2Kp->setValue(receivedData[ARD_PID2_KP].last());
+    if (LatestValue(ARD_PID2_KP, &value)) {
+        ui->doubleSpinBoxP2Kp->setValue(value);
     }
-    if (!receivedData[ARD_PID2_KI].isEmpty()) {
-        ui->doubleSpinBoxP2Ki->setValue(receivedData[ARD_PID2_KI].last());
+    if (LatestValue(ARD_PID2_KI, &value)) {
+        ui->doubleSpinBoxP2Ki->setValue(value);
     }
-    if (!receivedData[ARD_PID2_KD].isEmpty()) {
-        ui->doubleSpinBoxP2Kd->setValue(receivedData[ARD_PID2_KD].last());
+    if (LatestValue(ARD_PID2_KD, &value)) {
+        ui->doubleSpinBoxP2Kd->setValue(value);
     }
 
     //PID3
-    if (!receivedData[ARD_PID3_INPUT].isEmpty()) {
-        ui->lineEditP3Input->setText(QString::number(receivedData[ARD_PID3_INPUT].last()));
+    if (LatestValue(ARD_PID3_INPUT, &value)) {
+        ui->lineEditP3Input->setText(QString::number(value));
     }
-    if (!receivedData[ARD_PID3_OUTPUT].isEmpty()) {
-        ui->lineEditP3Output->setText(QString::number(receivedData[ARD_PID3_OUTPUT].last()));
+    if (LatestValue(ARD_PID3_OUTPUT, &value)) {
+        ui->lineEditP3Output->setText(QString::number(value));
     }
-    if (!receivedData[ARD_PID3_SETPOINT].isEmpty()) {
-        ui->doubleSpinBoxP3Setpoint->setValue(receivedData[ARD_PID3_SETPOINT].last());
+    if (LatestValue(ARD_PID3_SETPOINT, &value)) {
+        ui->doubleSpinBoxP3Setpoint->setValue(value);
     }
-    if (!receivedData[ARD_PID3_KP].isEmpty()) {
-        ui->doubleSpinBoxP3Kp->setValue(receivedData[ARD_PID3_KP].last());
+    if (LatestValue(ARD_PID3_KP, &value)) {
+        ui->doubleSpinBoxP3Kp->setValue(value);
     }
-    if (!receivedData[ARD_PID3_KI].isEmpty()) {
-        ui->doubleSpinBoxP3Ki->setValue(receivedData[ARD_PID3_KI].last());
+    if (LatestValue(ARD_PID3_KI, &value)) {
+        ui->doubleSpinBoxP3Ki->setValue(value);
     }
-    if (!receivedData[ARD_PID3_KD].isEmpty()) {
-        ui->doubleSpinBoxP3Kd->setValue(receivedData[ARD_PID3_KD].last());
+    if (LatestValue(ARD_PID3_KD, &value)) {
+        ui->doubleSpinBoxP3Kd->setValue(value);
     }
 
     //RunTimes
-    if (!receivedData[ARD_NORMAL_LOOP_TIME].isEmpty()) {
-        ui->labelNormalCycTime->setText(QString::number(receivedData[ARD_NORMAL_LOOP_TIME].last()));
+    if (LatestValue(ARD_NORMAL_LOOP_TIME, &value)) {
+        ui->labelNormalCycTime->setText(QString::number(value));
     }
-    if (!receivedData[ARD_SERIAL_LOOP_TIME].isEmpty()) {
-        ui->labelSerialCycTime->setText(QString::number(receivedData[ARD_SERIAL_LOOP_TIME].last()));
+    if (LatestValue(ARD_SERIAL_LOOP_TIME, &value)) {
+        ui->labelSerialCycTime->setText(QString::number(value));
     }
 
     BlockSignals(false);
 }
 
-QVector<double> NormalizeVect(QVector<double> values, double range)
+void MainWindow::PollData()
 {
-    QVector<double> retVct;
-    for (auto val : values) {
-        retVct.push_back(val / range);
+    // the rings are drained even with nothing connected: a source that just disconnected may have left samples in its ring
+    if (replaying && !ui->horizontalSliderReplay->isSliderDown()) {
+        ui->horizontalSliderReplay->setValue(qRound(replayer->Position() / qMax(replayer->Duration(), 1e-9) * ui->horizontalSliderReplay->maximum()));
     }
-    return retVct;
-}
 
-void MainWindow::RealTimeDataSlot()
-{
-    static QTime time(QTime::currentTime());
-    // calculate two new data points:
-    double curTime = time.elapsed() / 1000.0; // time elapsed since start of demo, in seconds
-    static double lastTime = 0;
+    // add data to lines:
+#ifdef BATCHED_DELIVERY
+    for (const SampleBatchPtr& batch : pendingBatches) {
+        for (const SampleBatch::Channel& block : batch->channels) {
+            AddChannelData(block.channel, block.keys, block.values);
+        }
+    }
+    pendingBatches.clear();
+#endif
+    // a replay always delivers through its ring, also in batch delivery mode where the source rings stay empty
+    DrainSamples();
+    for (int id : drainedChannels) {
+        ChannelBuffer& buffer = channelBuffers[id];
+        AddChannelData(id, buffer.keys, buffer.values);
+        buffer.keys.resize(0);
+        buffer.values.resize(0);
+    }
+    drainedChannels.resize(0);
 
-    if (Connected == false) {
-        return;
+    if (!updatedChannels.isEmpty()) {
+        UpdateComponentValues();
+        for (int id : updatedChannels) {
+            channelBuffers[id].updated = false;
+        }
+        updatedChannels.resize(0);
+        frameScheduler->RequestFrame();
     }
 
-    if (curTime - lastTime > 0.002) // at most add point every 2 ms
-    {
-        // add data to lines:
-        QMutexLocker locker(&mutexRecData);
-        if (scaleData) {
-            ui->customPlotPid1->graph(0)->addData(receivedDataTimestamps[ARD_PID1_INPUT], NormalizeVect(receivedData[ARD_PID1_INPUT], SCALE_PID1_INPUT), true);
-            ui->customPlotPid1->graph(1)->addData(receivedDataTimestamps[ARD_PID1_OUTPUT], NormalizeVect(receivedData[ARD_PID1_OUTPUT], SCALE_PID1_OUTPUT), true);
-            ui->customPlotPid1->graph(2)->addData(receivedDataTimestamps[ARD_PID1_SETPOINT], NormalizeVect(receivedData[ARD_PID1_SETPOINT], SCALE_PID1_SETPOINT), true);
-
-            ui->customPlotPid2->graph(0)->addData(receivedDataTimestamps[ARD_PID2_INPUT], NormalizeVect(receivedData[ARD_PID2_INPUT], SCALE_PID2_INPUT), true);
-            ui->customPlotPid2->graph(1)->addData(receivedDataTimestamps[ARD_PID2_OUTPUT], NormalizeVect(receivedData[ARD_PID2_OUTPUT], SCALE_PID2_OUTPUT), true);
-            ui->customPlotPid2->graph(2)->addData(receivedDataTimestamps[ARD_PID2_SETPOINT], NormalizeVect(receivedData[ARD_PID2_SETPOINT], SCALE_PID2_SETPOINT), true);
-
-            ui->customPlotPid3->graph(0)->addData(receivedDataTimestamps[ARD_PID3_INPUT], NormalizeVect(receivedData[ARD_PID3_INPUT], SCALE_PID3_INPUT), true);
-            ui->customPlotPid3->graph(1)->addData(receivedDataTimestamps[ARD_PID3_OUTPUT], NormalizeVect(receivedData[ARD_PID3_OUTPUT], SCALE_PID3_OUTPUT), true);
-            ui->customPlotPid3->graph(2)->addData(receivedDataTimestamps[ARD_PID3_SETPOINT], NormalizeVect(receivedData[ARD_PID3_SETPOINT], SCALE_PID3_SETPOINT), true);
-        } else {
-            ui->customPlotPid1->graph(0)->addData(receivedDataTimestamps[ARD_PID1_INPUT], receivedData[ARD_PID1_INPUT], true);
-            ui->customPlotPid1->graph(1)->addData(receivedDataTimestamps[ARD_PID1_OUTPUT], receivedData[ARD_PID1_OUTPUT], true);
-            ui->customPlotPid1->graph(2)->addData(receivedDataTimestamps[ARD_PID1_SETPOINT], receivedData[ARD_PID1_SETPOINT], true);
-
-            ui->customPlotPid2->graph(0)->addData(receivedDataTimestamps[ARD_PID2_INPUT], receivedData[ARD_PID2_INPUT], true);
-            ui->customPlotPid2->graph(1)->addData(receivedDataTimestamps[ARD_PID2_OUTPUT], receivedData[ARD_PID2_OUTPUT], true);
-            ui->customPlotPid2->graph(2)->addData(receivedDataTimestamps[ARD_PID2_SETPOINT], receivedData[ARD_PID2_SETPOINT], true);
-
-            ui->customPlotPid3->graph(0)->addData(receivedDataTimestamps[ARD_PID3_INPUT], receivedData[ARD_PID3_INPUT], true);
-            ui->customPlotPid3->graph(1)->addData(receivedDataTimestamps[ARD_PID3_OUTPUT], receivedData[ARD_PID3_OUTPUT], true);
-            ui->customPlotPid3->graph(2)->addData(receivedDataTimestamps[ARD_PID3_SETPOINT], receivedData[ARD_PID3_SETPOINT], true);
-
-            //     ui->customPlotPid1->yAxis->rescale(true);
-            //    ui->customPlotPid2->yAxis->rescale(true);
-            //     ui->customPlotPid3->yAxis->rescale(true);
+    if (Connected || replaying) {
+        UpdateStatusBar();
+    }
+}
+
+void MainWindow::RenderFrame()
+{
+    dirtyPlots.resize(0);
+    for (int p = 0; p < plots.size(); p++) {
+        if (!plotRefresh[p].dirty) {
+            continue;
+        }
+        dirtyPlots.append(p);
+
+        // the axes are adjusted here on the gui thread, their rangeChanged signals drive the secondary axes.
+        // make key axis range scroll with the data; it follows the newest sample of the plot rather than
+        // the clock, so a plot stands still (and isn't redrawn) while none of its channels receive anything
+        QCustomPlot* plot = plots[p];
+        plot->xAxis->setRange(plotRefresh[p].latestKey, SecondsToPlot, Qt::AlignRight);
+        if (!plotRefresh[p].full) {
+            plot->snapScrollRange(plot->xAxis); // so ReplotPlot can shift the last frame, and xAxis2 follows the snapped range
+        }
+#ifdef AUTOSCALE_VALUE_AXIS
+        // fit the value axis to the visible samples; the graph containers answer this from their value summaries
+        bool first = true;
+        for (int g = 0; g < plot->graphCount(); g++) {
+            if (plot->graph(g)->visible()) {
+                plot->graph(g)->rescaleValueAxis(!first, true);
+                first = false;
+            }
         }
+#endif
+    }
 
-        UpdateComponentValues();
-        receivedData.clear();
-        receivedDataTimestamps.clear();
+#if defined(PARALLEL_REPLOT) && !defined(USE_OPENGL)
+    // the plots render into their own QImage buffers on the thread pool, the gui thread only composites them
+    QtConcurrent::blockingMap(dirtyPlots, [this](int p) { ReplotPlot(p, QCustomPlot::rpNoRefresh); });
+    for (int p : dirtyPlots) {
+        plots[p]->update();
+    }
+#else
+    for (int p : dirtyPlots) {
+        ReplotPlot(p, QCustomPlot::rpRefreshHint);
+    }
+#endif
+    frameCount++;
+}
+
+void MainWindow::ReplotPlot(int p, QCustomPlot::RefreshPriority refreshPriority)
+{
+    PlotRefresh& refresh = plotRefresh[p];
+    QCustomPlot* plot = plots[p];
 
-        lastTime = curTime;
+    if (refresh.full) {
+        plot->replot(refreshPriority);
+    } else {
+        // shift the previous frame and draw only the new strip and the new samples
+        plot->scrollReplot(plot->layer("main"), plot->xAxis, refresh.dirtyFrom, refreshPriority);
     }
+    refresh.dirtyFrom = qQNaN();
+    refresh.dirty = false;
+    refresh.full = false;
+}
 
-    // make key axis range scroll with the data (at a constant range size of 8):
-    ui->customPlotPid1->xAxis->setRange(curTime, SecondsToPlot, Qt::AlignRight);
-    ui->customPlotPid1->replot();
-    ui->customPlotPid2->xAxis->setRange(curTime, SecondsToPlot, Qt::AlignRight);
-    ui->customPlotPid2->replot();
-    ui->customPlotPid3->xAxis->setRange(curTime, SecondsToPlot, Qt::AlignRight);
-    ui->customPlotPid3->replot();
+void MainWindow::RequestFullReplot()
+{
+    for (QCustomPlot* plot : plots) {
+        MarkPlotRestyled(plot);
+    }
+}
 
-    // calculate frames per second:
+void MainWindow::UpdateStatusBar()
+{
+    double curTime = HostClock::Seconds();
     static double lastFpsTimeSlice;
-    static int frameCount;
 
-    ++frameCount;
     if (curTime - lastFpsTimeSlice > 2) // average fps over 2 seconds
     {
+        int dataPoints = 0;
+        for (QCPGraph* graph : channelGraphs) {
+            dataPoints += graph ? graph->data()->size() : 0;
+        }
+        LinkStats total;
+        quint64 dropped = 0;
+        for (const SerialSource& source : sources) {
+            dropped += source.worker->SampleRing()->Dropped();
+            Count(total.malformed, source.worker->Stats().malformed.load());
+            Count(total.truncated, source.worker->Stats().truncated.load());
+            Count(total.discarded, source.worker->Stats().discarded.load());
+        }
         ui->statusBar->showMessage(
-            QString("%1 FPS, Total Data points: %2")
+            QString("%1 FPS, Skipped frames: %2, Total Data points: %3, Dropped samples: %4, Malformed: %5, Truncated: %6, Discarded: %7, Clock drift: %8 ppm")
                 .arg(frameCount / (curTime - lastFpsTimeSlice), 0, 'f', 0)
-                .arg(ui->customPlotPid1->graph(0)->data()->size() + ui->customPlotPid1->graph(1)->data()->size()),
+                .arg(frameScheduler->SkippedFrames())
+                .arg(dataPoints)
+                .arg(dropped)
+                .arg(total.malformed.load())
+                .arg(total.truncated.load())
+                .arg(total.discarded.load())
+                .arg(sources[PRIMARY_SOURCE].worker->ClockDriftPpm(), 0, 'f', 1)
+                + (recorder->IsRecording() ? QString(", Recorded: %1 MB, Dropped chunks: %2")
+                                                 .arg(recorder->BytesWritten() / 1e6, 0, 'f', 1)
+                                                 .arg(recorder->DroppedChunks())
+                                           : QString()),
             0);
         lastFpsTimeSlice = curTime;
         frameCount = 0;
     }
 }
 
-void MainWindow::ReceiveDataDoubleFromWroker(char cmd, double value, double timestamp)
+QCPGraph* MainWindow::GraphForChannel(int channel)
+{
+    QCPGraph* graph = channelGraphs[channel];
+    if (graph != nullptr) {
+        return graph;
+    }
+
+    const ChannelInfo& info = channelRegistry.Info(channel);
+    if (!info.IsValid() || info.plot < 0 || info.plot >= plots.size()) {
+        return nullptr; // not plotted (pid gains, loop times, ...)
+    }
+    graph = plots[info.plot]->addGraph();
+    graph->data()->setCapacity(PLOT_HISTORY_CAPACITY);
+    ApplyChannelInfo(graph, info);
+    channelGraphs[channel] = graph;
+    return graph;
+}
+
+void MainWindow::ApplyChannelInfo(QCPGraph* graph, const ChannelInfo& info)
+{
+    MarkPlotRestyled(graph->parentPlot());
+    graph->setPen(QPen(info.color));
+    graph->setName(info.unit.isEmpty() ? info.name : QString("%1 [%2]").arg(info.name, info.unit));
+    // normalization is applied while drawing, the graph keeps the samples in device units
+    graph->setValueTransform(scaleData && info.scale != 0 ? 1.0 / info.scale : 1.0);
+}
+
+void MainWindow::AddChannelData(int channel, const QVector<double>& keys, const QVector<double>& values)
 {
+    if (values.isEmpty()) {
+        return;
+    }
+    ChannelBuffer& buffer = channelBuffers[channel];
+    if (!buffer.updated) {
+        buffer.updated = true;
+        updatedChannels.append(channel);
+    }
+    buffer.latest = values.last();
+    for (SpectrumViewer* viewer : spectrumViewers) {
+        if (viewer != nullptr && viewer->Channel() == channel) {
+            viewer->AddSamples(keys, values);
+        }
+    }
+
+    QCPGraph* graph = GraphForChannel(channel);
+    if (graph == nullptr) {
+        return;
+    }
+    // the line from the last plotted sample to the new ones has to be drawn as well
+    double dirtyFrom = graph->data()->isEmpty() ? keys.first() : (graph->data()->constEnd() - 1)->key;
+    PlotRefresh& refresh = plotRefresh[plots.indexOf(graph->parentPlot())];
+    if (qIsNaN(refresh.dirtyFrom) || dirtyFrom < refresh.dirtyFrom) {
+        refresh.dirtyFrom = dirtyFrom;
+    }
+    refresh.latestKey = qMax(refresh.latestKey, keys.last());
+    refresh.dirty = true;
+    graph->addData(keys, values, true);
+}
 
-    QMutexLocker locker(&mutexRecData);
-    receivedData[cmd].append(value);
-    receivedDataTimestamps[cmd].append(timestamp);
+void MainWindow::MarkPlotRestyled(QCustomPlot* plot)
+{
+    int p = plots.indexOf(plot);
+    if (p >= 0) {
+        plotRefresh[p].full = true;
+        plotRefresh[p].dirty = true;
+    }
+    if (frameScheduler != nullptr) { // graphs are created in the constructor before the scheduler
+        frameScheduler->RequestFrame();
+    }
+}
+
+bool MainWindow::LatestValue(int channel, double* value)
+{
+    const ChannelBuffer& buffer = channelBuffers[PRIMARY_SOURCE * CHANNELS_PER_SOURCE + channel];
+    *value = buffer.latest;
+    return buffer.updated;
+}
+
+void MainWindow::ChannelAnnounced(ChannelInfo info)
+{
+    QCPGraph* graph = channelGraphs[info.id];
+    if (graph != nullptr && graph->parentPlot() != plots.value(info.plot)) { // moved to another plot
+        MarkPlotRestyled(graph->parentPlot());
+        graph->parentPlot()->removeGraph(graph);
+        channelGraphs[info.id] = nullptr;
+        graph = nullptr;
+    }
+
+    channelRegistry.Register(info);
+    if (graph != nullptr) {
+        ApplyChannelInfo(graph, info);
+    } else {
+        GraphForChannel(info.id);
+    }
+    SetPidDefaultRanges(scaleData);
+}
+
+void MainWindow::ReceiveSampleBatch(SampleBatchPtr batch)
+{
+    pendingBatches.append(batch);
+}
+
+void MainWindow::DrainSamples()
+{
+    /* every source has its own ring, so the ports never contend with each other;
+       a channel only ever comes from one source, which keeps its timestamps sorted */
+    for (const SerialSource& source : sources) {
+        DrainRing(source.worker->SampleRing());
+    }
+    if (replaying) { // a replay goes through the same path as a live source
+        DrainRing(replayer->SampleRing());
+    }
+}
+
+void MainWindow::DrainRing(SpscRing<Sample>* ring)
+{
+    int count;
+    while ((count = ring->Pop(drainBuffer.data(), drainBuffer.size())) > 0) {
+        for (int i = 0; i < count; i++) {
+            const Sample& sample = drainBuffer[i];
+            if (sample.channel < 0 || sample.channel >= channelBuffers.size()) {
+                continue; // recorded with a larger MAX_SOURCES
+            }
+            ChannelBuffer& buffer = channelBuffers[sample.channel];
+            if (buffer.values.isEmpty()) {
+                drainedChannels.append(sample.channel);
+            }
+            buffer.keys.append(sample.timestamp);
+            buffer.values.append(sample.value);
+        }
+    }
 }
 
 void MainWindow::SendCommand(uint8_t cmd)
@@ -455,7 +736,7 @@ void MainWindow::SendCommand(uint8_t cmd)
     QByteArray data;
     data.append(cmd);
     data.append('\n');
-    emit requestSendData(data);
+    QMetaObject::invokeMethod(sources[PRIMARY_SOURCE].worker, "PortSendData", Q_ARG(QByteArray, data));
 }
 
 void MainWindow::SendCommand(uint8_t cmd, QString val)
@@ -464,28 +745,44 @@ void MainWindow::SendCommand(uint8_t cmd, QString val)
     data.append(cmd);
     data.append(val);
     data.append('\n');
-    emit requestSendData(data);
+    QMetaObject::invokeMethod(sources[PRIMARY_SOURCE].worker, "PortSendData", Q_ARG(QByteArray, data));
 }
 
 //------------------------------------------ ON SLOTS -------------------------------------------//
 
 void MainWindow::on_pushButtonConnect_clicked()
 {
-    /* If application is not connected, connect */
+    if (replaying) {
+        ui->statusBar->showMessage("Stop the replay before connecting", 3000);
+        return;
+    }
+
+    /* Connect the selected source */
     /* Get parameters from controls first */
     QString portName = ui->comboPort->currentText(); // Get port name from combo box
     int baudRate = ui->comboBaud->currentText().toInt(); // Get baud rate from combo box
     int dataBitsIndex = ui->comboData->currentIndex(); // Get index of data bits combo box
     int parityIndex = ui->comboParity->currentIndex(); // Get index of parity combo box
     int stopBitsIndex = ui->comboStop->currentIndex(); // Get index of stop bits combo box
+    bool binaryFrames = ui->checkBoxBinaryFrames->isChecked(); // Ask the device for binary frames instead of text lines
 
     /* Open serial port and connect its signals */
-    emit requestConnect(portName, baudRate, dataBitsIndex, parityIndex, stopBitsIndex);
+    QMetaObject::invokeMethod(sources[SelectedSource()].worker, "PortConnect",
+        Q_ARG(QString, portName), Q_ARG(int, baudRate), Q_ARG(int, dataBitsIndex),
+        Q_ARG(int, parityIndex), Q_ARG(int, stopBitsIndex), Q_ARG(bool, binaryFrames));
 }
 
 void MainWindow::on_pushButtonDisconnect_clicked()
 {
-    emit requestDisconnect();
+    QMetaObject::invokeMethod(sources[SelectedSource()].worker, "PortDisconnect");
+}
+
+void MainWindow::on_comboSource_currentIndexChanged(int index)
+{
+    if (index < 0 || index >= sources.size()) {
+        return; // still populating the combo box
+    }
+    EnableControls(!sources[index].connected);
 }
 
 void MainWindow::on_pushButtonGetPidCfgs_clicked()
@@ -575,6 +872,7 @@ void MainWindow::on_doubleSpinBoxP3Setpoint_valueChanged(const QString& arg1)
 
 void MainWindow::clearPidGraphData(QCustomPlot* plot)
 {
+    MarkPlotRestyled(plot);
     for (int g = 0; g < plot->graphCount(); g++) {
         plot->graph(g)->data()->clear();
     }
@@ -589,15 +887,179 @@ void MainWindow::on_checkboxScaleGraphData_stateChanged(int arg1)
         scaleData = false;
         SetPidDefaultRanges(false);
     }
+    for (int id = 0; id < channelGraphs.size(); id++) {
+        if (channelGraphs[id] != nullptr) {
+            ApplyChannelInfo(channelGraphs[id], channelRegistry.Info(id));
+        }
+    }
 
     //clearPidGraphData(ui->customPlotPid1);
     // clearPidGraphData(ui->customPlotPid2);
     // clearPidGraphData(ui->customPlotPid3);
 }
 
+void MainWindow::on_checkBoxRecord_stateChanged(int arg1)
+{
+    if (arg1 != Qt::Checked) {
+        recorder->Stop();
+        return;
+    }
+
+    QString fileName = QFileDialog::getSaveFileName(this, "Record session",
+        QDir::homePath() + "/" + QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss") + "." SESSION_FILE_SUFFIX,
+        "Sessions (*." SESSION_FILE_SUFFIX ")");
+#ifdef SESSION_RECORD_RAW
+    const bool recordRaw = true;
+#else
+    const bool recordRaw = false;
+#endif
+    if (fileName.isEmpty() || !recorder->Start(fileName, recordRaw)) {
+        ui->checkBoxRecord->blockSignals(true);
+        ui->checkBoxRecord->setChecked(false);
+        ui->checkBoxRecord->blockSignals(false);
+    }
+}
+
+void MainWindow::on_pushButtonReplay_clicked()
+{
+    if (replaying) {
+        QMetaObject::invokeMethod(replayer, "Close", Qt::BlockingQueuedConnection);
+        SetReplaying(false);
+        return;
+    }
+    if (Connected) {
+        ui->statusBar->showMessage("Disconnect all sources before replaying a session", 3000);
+        return;
+    }
+
+    QString fileName = QFileDialog::getOpenFileName(this, "Replay session", QDir::homePath(), "Sessions (*." SESSION_FILE_SUFFIX ")");
+    if (!fileName.isEmpty()) {
+        QMetaObject::invokeMethod(replayer, "Open", Q_ARG(QString, fileName));
+    }
+}
+
+void MainWindow::ReplayOpened(double duration)
+{
+    ClearAllGraphs();
+    SetReplaying(true);
+    QMetaObject::invokeMethod(replayer, "Play", Q_ARG(double, ReplaySpeed()));
+    qDebug() << "Replaying" << duration << "s";
+}
+
+void MainWindow::ReplayOpenFailed()
+{
+    ui->statusBar->showMessage("Can't replay this file", 3000);
+}
+
+void MainWindow::ReplayFinished()
+{
+    ui->statusBar->showMessage("Replay finished", 3000);
+}
+
+void MainWindow::SetReplaying(bool replaying)
+{
+    this->replaying = replaying;
+    ui->pushButtonReplay->setText(replaying ? "Stop replay" : "Replay session...");
+    ui->horizontalSliderReplay->setEnabled(replaying);
+    ui->horizontalSliderReplay->setValue(0);
+    ui->pushButtonConnect->setEnabled(!replaying && !sources[SelectedSource()].connected);
+}
+
+double MainWindow::ReplaySpeed() const
+{
+    QString speed = ui->comboReplaySpeed->currentText();
+    if (!speed.endsWith('x')) {
+        return 0; // "Max": as fast as the plots take the samples
+    }
+    speed.chop(1);
+    return speed.toDouble();
+}
+
+void MainWindow::on_comboReplaySpeed_currentIndexChanged(int index)
+{
+    Q_UNUSED(index);
+    if (replaying) {
+        QMetaObject::invokeMethod(replayer, "Play", Q_ARG(double, ReplaySpeed()));
+    }
+}
+
+void MainWindow::on_horizontalSliderReplay_sliderReleased()
+{
+    if (!replaying) {
+        return;
+    }
+    double seconds = replayer->Duration() * ui->horizontalSliderReplay->value() / ui->horizontalSliderReplay->maximum();
+    // paused, the replayer pushes nothing while the ring is drained, so everything in it is from before the seek
+    QMetaObject::invokeMethod(replayer, "Pause", Qt::BlockingQueuedConnection);
+    QMetaObject::invokeMethod(replayer, "Seek", Qt::BlockingQueuedConnection, Q_ARG(double, seconds));
+    while (replayer->SampleRing()->Pop(drainBuffer.data(), drainBuffer.size()) > 0) {
+    }
+    ClearAllGraphs();
+    QMetaObject::invokeMethod(replayer, "Play", Q_ARG(double, ReplaySpeed())); // continues after a finished replay too
+}
+
+void MainWindow::on_pushButtonOpenRecording_clicked()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, "Open recording", QDir::homePath(), "Sessions (*." SESSION_FILE_SUFFIX ")");
+    if (fileName.isEmpty()) {
+        return;
+    }
+    RecordingViewer* viewer = new RecordingViewer(channelRegistry, this);
+    if (!viewer->Open(fileName)) {
+        delete viewer;
+        ui->statusBar->showMessage("Can't read " + fileName, 3000);
+        return;
+    }
+    viewer->show();
+}
+
+void MainWindow::on_pushButtonSpectrum_clicked()
+{
+    QStringList names;
+    QVector<int> channels;
+    int current = 0;
+    for (int id = 0; id < channelRegistry.Size(); id++) {
+        if (!channelRegistry.Info(id).IsValid()) {
+            continue;
+        }
+        if (id == PRIMARY_SOURCE * CHANNELS_PER_SOURCE + ARD_PID3_INPUT) {
+            current = channels.size();
+        }
+        names.append(QString("%1 (%2)").arg(channelRegistry.Info(id).name).arg(id)); // names repeat across sources
+        channels.append(id);
+    }
+    bool ok = false;
+    QString name = QInputDialog::getItem(this, "Spectrum", "Channel:", names, current, false, &ok);
+    if (!ok || names.indexOf(name) < 0) {
+        return;
+    }
+
+    spectrumViewers.removeAll(QPointer<SpectrumViewer>());
+    SpectrumViewer* viewer = new SpectrumViewer(channelRegistry, channels[names.indexOf(name)], this);
+    spectrumViewers.append(viewer);
+    viewer->show();
+}
+
+void MainWindow::ClearAllGraphs()
+{
+    for (QCustomPlot* plot : plots) {
+        clearPidGraphData(plot);
+    }
+    for (SpectrumViewer* viewer : spectrumViewers) {
+        if (viewer != nullptr) {
+            viewer->Clear();
+        }
+    }
+    for (PlotRefresh& refresh : plotRefresh) {
+        refresh.latestKey = 0;
+        refresh.dirtyFrom = qQNaN();
+    }
+}
+
 void MainWindow::on_doubleSpinBoxSecondsToPlot_valueChanged(double arg1)
 {
     SecondsToPlot = arg1;
+    RequestFullReplot();
 }
 
 void MainWindow::on_pushButtonSavePidConfigs_clicked()
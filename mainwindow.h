@@ -2,11 +2,18 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include <QPointer>
 #include <QSerialPort>
 #include <QSerialPortInfo>
+#include <QThread>
 
+#include "channelregistry.h"
+#include "framescheduler.h"
 #include "qcustomplot.h"
 #include "serialworker.h"
+#include "sessionrecorder.h"
+#include "sessionreplayer.h"
+#include "spectrumviewer.h"
 
 namespace Ui {
 class MainWindow;
@@ -19,43 +26,94 @@ public:
     explicit MainWindow(QWidget* parent = 0);
     ~MainWindow();
 
-signals:
-    void requestConnect(QString portName, int baudRate, int dataBitsIndex, int parityIndex, int stopBitsIndex);
-    void requestDisconnect();
-    void requestSendData(const QByteArray data);
-
 private:
-    bool Connected = false;
+    /* One serial port with its own worker thread; see MAX_SOURCES */
+    struct SerialSource {
+        SerialWorker* worker = nullptr;
+        QThread* thread = nullptr;
+        bool connected = false;
+    };
+
+    bool Connected = false; // any source connected
+    bool replaying = false; // a session replay feeds the plots instead of the sources
     bool scaleData = false;
     double SecondsToPlot = 20;
+    int frameCount = 0; // rendered since the last status bar update
 
-    QMutex mutexRecData;
     Ui::MainWindow* ui;
-    SerialWorker* serialWorker;
-    QThread serialWorkerThread;
+    FrameScheduler* frameScheduler = nullptr;
+    SessionRecorder* recorder = nullptr; // shared by all sources
+    SessionReplayer* replayer = nullptr; // on replayThread
+    QThread* replayThread = nullptr;
+    QVector<SerialSource> sources;
+    /* Samples of one channel received since the last frame, indexed by channel id */
+    struct ChannelBuffer {
+        QVector<double> keys; // reused, only resized to 0 between frames
+        QVector<double> values;
+        bool updated = false; // received something since the last UpdateComponentValues
+        double latest = 0;
+    };
+
+    /* What has to be redrawn on the next frame of a plot */
+    struct PlotRefresh {
+        double latestKey = 0; // newest sample on this plot, the right edge of its x axis
+        double dirtyFrom = qQNaN(); // smallest key whose line changed, NaN if no new data
+        bool dirty = false; // new data or a changed view; untouched plots skip the frame
+        bool full = false; // graphs were added, removed or restyled: no scroll replot
+    };
+
     QSharedPointer<QCPAxisTickerTime> timeTicker;
-    QHash<int, QVector<double> > receivedData;
-    QHash<int, QVector<double> > receivedDataTimestamps;
+    QVector<QCustomPlot*> plots; // ChannelInfo::plot indexes this
+    QVector<PlotRefresh> plotRefresh; // same index as plots
+    QVector<int> dirtyPlots; // replotted in the current frame
+    ChannelRegistry channelRegistry;
+    QVector<ChannelBuffer> channelBuffers; // same ids as channelRegistry
+    QVector<QCPGraph*> channelGraphs; // created on first use, null if not plotted
+    QVector<int> drainedChannels; // channels with samples in channelBuffers this frame
+    QVector<int> updatedChannels; // channels with ChannelBuffer::updated set
+    QVector<Sample> drainBuffer; // reused every frame to pull samples out of the worker's ring
+    QVector<SampleBatchPtr> pendingBatches; // batch delivery mode
+    QList<QPointer<SpectrumViewer>> spectrumViewers; // null once the window is closed
 
     void ConfigurePidPlot(QCustomPlot*);
-    void CreateSerialWorker(); //Create the serialWorker thread
+    void CreateSerialWorkers(); //Create one serialWorker thread per source
     void ConfigureConnectionControls(); // Populate the controls
-    void EnableControls(bool enable); // Enable/disable controls
+    void EnableControls(bool enable); // Enable/disable the port controls of the selected source
+    void EnablePidControls(bool enable);
+    void SetSourceConnected(int source, bool connected);
+    int SelectedSource() const;
     void UpdateComponentValues();
     void SendCommand(uint8_t cmd, QString val);
     void SendCommand(uint8_t cmd);
     void BlockSignals(bool enable);
     void clearPidGraphData(QCustomPlot* plot);
     void SetPidDefaultRanges(bool normalized);
+    void LoadChannelRegistry();
+    void DrainSamples(); // move everything the serial threads produced into channelBuffers
+    void DrainRing(SpscRing<Sample>* ring);
+    void ClearAllGraphs(); // before replayed samples, which start over at 0 s
+    void SetReplaying(bool replaying);
+    double ReplaySpeed() const;
+    QCPGraph* GraphForChannel(int channel);
+    void ApplyChannelInfo(QCPGraph* graph, const ChannelInfo& info);
+    void MarkPlotRestyled(QCustomPlot* plot);
+    void AddChannelData(int channel, const QVector<double>& keys, const QVector<double>& values);
+    bool LatestValue(int channel, double* value); // channel of the primary source
+    void ReplotPlot(int p, QCustomPlot::RefreshPriority refreshPriority); // may run on a worker thread, touches only plot p
+    void RequestFullReplot(); // after changes the scroll replot can't see (window size)
+    void UpdateStatusBar();
 
 private slots:
 
-    void RealTimeDataSlot();
-    void ReceiveDataDoubleFromWroker(char cmd, double value, double timestamp);
-    void serialConnectOk();
-    void serialConnectFailed();
-    void serialPortClosed();
+    void PollData(); // FrameScheduler tick: move new samples into the graphs
+    void RenderFrame(); // FrameScheduler tick with a pending frame
+    void ReceiveSampleBatch(SampleBatchPtr batch);
+    void ChannelAnnounced(ChannelInfo info);
+    void serialConnectOk(int source);
+    void serialConnectFailed(int source);
+    void serialPortClosed(int source);
 
+    void on_comboSource_currentIndexChanged(int index);
     void on_pushButtonConnect_clicked();
     void on_pushButtonDisconnect_clicked();
     void on_pushButtonGetPidCfgs_clicked();
@@ -80,6 +138,15 @@ private slots:
     void on_doubleSpinBoxP3Kd_valueChanged(const QString& arg1);
     void on_doubleSpinBoxP3Setpoint_valueChanged(const QString& arg1);
     void on_checkboxScaleGraphData_stateChanged(int arg1);
+    void on_checkBoxRecord_stateChanged(int arg1);
+    void on_pushButtonReplay_clicked();
+    void on_comboReplaySpeed_currentIndexChanged(int index);
+    void on_horizontalSliderReplay_sliderReleased();
+    void on_pushButtonOpenRecording_clicked();
+    void on_pushButtonSpectrum_clicked();
+    void ReplayOpened(double duration);
+    void ReplayOpenFailed();
+    void ReplayFinished();
     void on_doubleSpinBoxSecondsToPlot_valueChanged(double arg1);
     void on_pushButtonSavePidConfigs_clicked();
 
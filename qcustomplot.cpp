@@ -25,6 +25,11 @@
 
 #include "qcustomplot.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define QCP_SSE2
+#  include <emmintrin.h>
+#endif
+
 
 /* including file 'src/vector2d.cpp', size 7340                              */
 /* commit 9868e55d3b412f2f89766bb482fcf299e93a0988 2017-09-04 01:56:22 +0200 */
@@ -615,6 +620,27 @@ void QCPAbstractPaintBuffer::setInvalidated(bool invalidated)
   mInvalidated = invalidated;
 }
 
+/*!
+  Shifts the contents of \a rect (in logical coordinates) by \a dx and \a dy pixels, within the
+  bounds of \a rect. The area uncovered by the shift keeps undefined content and must be redrawn
+  by the caller.
+
+  Returns false if the paint buffer backend doesn't support scrolling, in which case the buffer is
+  left unchanged. The default implementation does nothing and returns false.
+
+  This method must not be called if there is currently a painter (acquired with \ref startPainting)
+  active.
+
+  \see QCustomPlot::scrollReplot
+*/
+bool QCPAbstractPaintBuffer::scroll(int dx, int dy, const QRect &rect)
+{
+  Q_UNUSED(dx)
+  Q_UNUSED(dy)
+  Q_UNUSED(rect)
+  return false;
+}
+
 /*!
   Sets the the device pixel ratio to \a ratio. This is useful to render on high-DPI output devices.
   The ratio is automatically set to the device pixel ratio used by the parent QCustomPlot instance.
@@ -686,6 +712,17 @@ void QCPPaintBufferPixmap::clear(const QColor &color)
   mBuffer.fill(color);
 }
 
+/* inherits documentation from base class */
+bool QCPPaintBufferPixmap::scroll(int dx, int dy, const QRect &rect)
+{
+  // QPixmap::scroll works in device pixels, so only whole-numbered ratios keep the shift exact:
+  const int ratio = qRound(mDevicePixelRatio);
+  if (!qFuzzyCompare(mDevicePixelRatio, (double)ratio))
+    return false;
+  mBuffer.scroll(dx*ratio, dy*ratio, QRect(rect.topLeft()*ratio, rect.size()*ratio));
+  return true;
+}
+
 /* inherits documentation from base class */
 void QCPPaintBufferPixmap::reallocateBuffer()
 {
@@ -707,6 +744,104 @@ void QCPPaintBufferPixmap::reallocateBuffer()
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPPaintBufferImage
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPPaintBufferImage
+  \brief A paint buffer based on QImage, using software raster rendering
+
+  This paint buffer renders like \ref QCPPaintBufferPixmap, but holds a QImage. Unlike pixmaps,
+  images may be painted on outside the GUI thread, so a QCustomPlot using this buffer can be
+  replotted by a worker thread (e.g. several plots concurrently on a thread pool), while the GUI
+  thread only composites the finished buffers in the paint event. It is used if the plotting hint
+  \ref QCP::phImageBuffers is set and \ref QCustomPlot::setOpenGl is false.
+*/
+
+/*!
+  Creates an image paint buffer instance with the specified \a size and \a devicePixelRatio, if
+  applicable.
+*/
+QCPPaintBufferImage::QCPPaintBufferImage(const QSize &size, double devicePixelRatio) :
+  QCPAbstractPaintBuffer(size, devicePixelRatio)
+{
+  QCPPaintBufferImage::reallocateBuffer();
+}
+
+QCPPaintBufferImage::~QCPPaintBufferImage()
+{
+}
+
+/* inherits documentation from base class */
+QCPPainter *QCPPaintBufferImage::startPainting()
+{
+  QCPPainter *result = new QCPPainter(&mBuffer);
+  result->setRenderHint(QPainter::HighQualityAntialiasing);
+  return result;
+}
+
+/* inherits documentation from base class */
+void QCPPaintBufferImage::draw(QCPPainter *painter) const
+{
+  if (painter && painter->isActive())
+    painter->drawImage(0, 0, mBuffer);
+  else
+    qDebug() << Q_FUNC_INFO << "invalid or inactive painter passed";
+}
+
+/* inherits documentation from base class */
+void QCPPaintBufferImage::clear(const QColor &color)
+{
+  mBuffer.fill(color);
+}
+
+/* inherits documentation from base class */
+bool QCPPaintBufferImage::scroll(int dx, int dy, const QRect &rect)
+{
+  const int ratio = qRound(mDevicePixelRatio);
+  if (!qFuzzyCompare(mDevicePixelRatio, (double)ratio))
+    return false;
+  dx *= ratio;
+  dy *= ratio;
+  const QRect deviceRect = QRect(rect.topLeft()*ratio, rect.size()*ratio) & mBuffer.rect();
+  const QRect source = deviceRect & deviceRect.translated(-dx, -dy); // pixels that stay inside the rect
+  if (source.isEmpty())
+    return true;
+  
+  const int bytesPerPixel = mBuffer.depth()/8;
+  const int rowBytes = source.width()*bytesPerPixel;
+  // copy rows in the order that doesn't overwrite rows still to be read, memmove handles the overlap within a row:
+  for (int i=0; i<source.height(); ++i)
+  {
+    const int y = dy > 0 ? source.bottom()-i : source.top()+i;
+    uchar *line = mBuffer.scanLine(y+dy);
+    const uchar *sourceLine = mBuffer.constScanLine(y);
+    memmove(line+(source.left()+dx)*bytesPerPixel, sourceLine+source.left()*bytesPerPixel, rowBytes);
+  }
+  return true;
+}
+
+/* inherits documentation from base class */
+void QCPPaintBufferImage::reallocateBuffer()
+{
+  setInvalidated();
+  if (!qFuzzyCompare(1.0, mDevicePixelRatio))
+  {
+#ifdef QCP_DEVICEPIXELRATIO_SUPPORTED
+    mBuffer = QImage(mSize*mDevicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+    mBuffer.setDevicePixelRatio(mDevicePixelRatio);
+#else
+    qDebug() << Q_FUNC_INFO << "Device pixel ratios not supported for Qt versions before 5.4";
+    mDevicePixelRatio = 1.0;
+    mBuffer = QImage(mSize, QImage::Format_ARGB32_Premultiplied);
+#endif
+  } else
+  {
+    mBuffer = QImage(mSize, QImage::Format_ARGB32_Premultiplied);
+  }
+}
+
+
 #ifdef QCP_OPENGL_PBUFFER
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPPaintBufferGlPbuffer
@@ -1114,16 +1249,22 @@ void QCPLayer::setMode(QCPLayer::LayerMode mode)
 
   Draws the contents of this layer with the provided \a painter.
 
+  If \a clipRect is valid, drawing is restricted to it, in addition to the clip rect of each
+  layerable.
+
   \see replot, drawToPaintBuffer
 */
-void QCPLayer::draw(QCPPainter *painter)
+void QCPLayer::draw(QCPPainter *painter, const QRect &clipRect)
 {
   foreach (QCPLayerable *child, mChildren)
   {
     if (child->realVisibility())
     {
       painter->save();
-      painter->setClipRect(child->clipRect().translated(0, -1));
+      if (clipRect.isValid())
+        painter->setClipRect(child->clipRect().translated(0, -1).intersected(clipRect));
+      else
+        painter->setClipRect(child->clipRect().translated(0, -1));
       child->applyDefaultAntialiasingHint(painter);
       child->draw(painter);
       painter->restore();
@@ -1137,17 +1278,28 @@ void QCPLayer::draw(QCPPainter *painter)
   association is established by the parent QCustomPlot, which manages all paint buffers (see \ref
   QCustomPlot::setupPaintBuffers).
 
+  If \a clipRect is valid, only that part of the paint buffer is cleared (to \c Qt::transparent) and
+  redrawn, leaving the rest of the buffer untouched. This is used by \ref QCustomPlot::scrollReplot.
+
   \see draw
 */
-void QCPLayer::drawToPaintBuffer()
+void QCPLayer::drawToPaintBuffer(const QRect &clipRect)
 {
   if (!mPaintBuffer.isNull())
   {
     if (QCPPainter *painter = mPaintBuffer.data()->startPainting())
     {
       if (painter->isActive())
-        draw(painter);
-      else
+      {
+        if (clipRect.isValid())
+        {
+          painter->save();
+          painter->setCompositionMode(QPainter::CompositionMode_Source);
+          painter->fillRect(clipRect, Qt::transparent);
+          painter->restore();
+        }
+        draw(painter, clipRect);
+      } else
         qDebug() << Q_FUNC_INFO << "paint buffer returned inactive painter";
       delete painter;
       mPaintBuffer.data()->donePainting();
@@ -1176,6 +1328,7 @@ void QCPLayer::replot()
   {
     if (!mPaintBuffer.isNull())
     {
+      mParentPlot->mScrollKeyAxis = 0; // buffer no longer holds the frame scrollReplot remembers
       mPaintBuffer.data()->clear(Qt::transparent);
       drawToPaintBuffer();
       mPaintBuffer.data()->setInvalidated(false);
@@ -12886,6 +13039,9 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   QLocale currentLocale = locale();
   currentLocale.setNumberOptions(QLocale::OmitGroupSeparator);
   setLocale(currentLocale);
+#ifdef QCP_OPENGL_FBO
+  mGlLineRenderer = 0;
+#endif
 #ifdef QCP_DEVICEPIXELRATIO_SUPPORTED
 #  ifdef QCP_DEVICEPIXELRATIO_FLOAT
   setBufferDevicePixelRatio(QWidget::devicePixelRatioF());
@@ -12947,6 +13103,7 @@ QCustomPlot::~QCustomPlot()
 {
   clearPlottables();
   clearItems();
+  freeOpenGl(); // the graphs have released their vertex buffers, now the renderer can go
 
   if (mPlotLayout)
   {
@@ -13174,7 +13331,13 @@ void QCustomPlot::setNoAntialiasingOnDrag(bool enabled)
 */
 void QCustomPlot::setPlottingHints(const QCP::PlottingHints &hints)
 {
+  const bool bufferTypeChanged = hints.testFlag(QCP::phImageBuffers) != mPlottingHints.testFlag(QCP::phImageBuffers);
   mPlottingHints = hints;
+  if (bufferTypeChanged) // recreate paint buffers with the new backend
+  {
+    mPaintBuffers.clear();
+    setupPaintBuffers();
+  }
 }
 
 /*!
@@ -14393,6 +14556,13 @@ void QCustomPlot::deselectAll()
   If a layer is in mode \ref QCPLayer::lmBuffered (\ref QCPLayer::setMode), it is also possible to
   replot only that specific layer via \ref QCPLayer::replot. See the documentation there for
   details.
+
+  With the plotting hint \ref QCP::phImageBuffers set (and \ref QCP::phCacheLabels cleared), the
+  replot may also be performed by a worker thread with \a refreshPriority \ref
+  QCustomPlot::rpNoRefresh, as long as no other thread accesses this QCustomPlot meanwhile. This
+  allows replotting several plots concurrently. Afterwards, call QWidget::update from the GUI thread
+  to show the result. Note that \ref beforeReplot and \ref afterReplot are then emitted in the
+  worker thread.
 */
 void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
 {
@@ -14410,6 +14580,7 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
     return;
   mReplotting = true;
   mReplotQueued = false;
+  mScrollKeyAxis = 0;
   emit beforeReplot();
   
   updateLayout();
@@ -14422,13 +14593,226 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
   
   if ((refreshPriority == rpRefreshHint && mPlottingHints.testFlag(QCP::phImmediateRefresh)) || refreshPriority==rpImmediateRefresh)
     repaint();
-  else
+  else if (refreshPriority != rpNoRefresh)
+    update();
+  
+  emit afterReplot();
+  mReplotting = false;
+}
+
+/*!
+  Replots the plot like \ref replot, but reuses the previous frame of the plottables on \a layer if
+  only the range of \a keyAxis has been moved since then. This is intended for strip charts whose
+  key range slides along with incoming data: instead of redrawing all data in the visible window,
+  the paint buffer of \a layer is shifted by the number of pixels the key range moved, and only the
+  newly exposed columns are drawn. All other layers (grid, axes, legend,...) are redrawn as usual,
+  they are cheap compared to a large number of data points. If no axis range changed at all (only
+  data was added), the other layers are left untouched and only the dirty columns of \a layer are
+  redrawn.
+
+  For the shift to line up exactly, the range of \a keyAxis must have moved by a whole number of
+  pixels since the previous frame. Call \ref snapScrollRange after setting the new range to ensure
+  this, otherwise a complete replot is performed. This method itself never changes an axis range, so
+  it emits no range signals and may render the plot on a thread other than the one owning it (e.g.
+  with \ref rpNoRefresh on a thread pool), as long as nothing else touches the plot meanwhile.
+
+  Data that was added since the previous frame but lies before the newly exposed columns is not
+  drawn, unless its smallest key (or better, the key of the data point preceding it, so the
+  connecting line is redrawn as well) is passed as \a dirtyFromKey. All columns from \a dirtyFromKey
+  in the direction of increasing keys are then redrawn too.
+
+  \a layer must be in \ref QCPLayer::lmBuffered mode and should only contain the plottables of the
+  axis rect of \a keyAxis. The shift is only possible for a linear, horizontal \a keyAxis whose range
+  size is unchanged, when the layout, all other axis ranges of the axis rect and the viewport are
+  unchanged, and when the paint buffers support it (\ref QCPAbstractPaintBuffer::scroll, the OpenGL
+  buffers don't). Otherwise, and on the first call, a complete replot is performed. Changes to
+  plottable properties (e.g. pens) or data inside the reused part of the frame can not be detected,
+  call \ref replot after such changes. Any \ref replot or \ref QCPLayer::replot call in between
+  makes the next call of this method perform a complete replot.
+
+  Only the strip is redrawn, and plottables can limit their work to it: \ref QCPGraph draws only the
+  data points within the key span of the strip, except for the unselected line of an \ref
+  QCPGraph::lsLine graph, whose pixel polyline is cached between replots anyway. Other plottables
+  still process all their visible data, which is then clipped to the strip when rasterized.
+
+  \a refreshPriority has the same meaning as in \ref replot, except that \ref rpQueuedReplot
+  performs a queued complete replot.
+
+  \see replot
+*/
+void QCustomPlot::scrollReplot(QCPLayer *layer, QCPAxis *keyAxis, double dirtyFromKey, QCustomPlot::RefreshPriority refreshPriority)
+{
+  if (!layer || !keyAxis || layer->parentPlot() != this || keyAxis->parentPlot() != this)
+  {
+    qDebug() << Q_FUNC_INFO << "invalid layer or key axis";
+    return;
+  }
+  if (refreshPriority == QCustomPlot::rpQueuedReplot)
+  {
+    replot(refreshPriority);
+    return;
+  }
+  if (mReplotting) // incase signals loop back to replot slot
+    return;
+  
+  QCPAxisRect *axisRect = keyAxis->axisRect();
+  QList<QCPAxis*> axes = axisRect->axes();
+  const int keyAxisIndex = axes.indexOf(keyAxis);
+  bool canScroll = mScrollLayer == layer && mScrollKeyAxis == keyAxis && layer->mode() == QCPLayer::lmBuffered &&
+      keyAxis->orientation() == Qt::Horizontal && keyAxis->scaleType() == QCPAxis::stLinear &&
+      mScrollAxisRanges.size() == axes.size() && keyAxisIndex >= 0 && mScrollRect.width() > 0;
+  int dx = 0;
+  if (canScroll)
+  {
+    // the key range must be a whole pixel offset from the previous frame, see snapScrollRange:
+    const QCPRange oldRange = mScrollAxisRanges.at(keyAxisIndex);
+    const QCPRange newRange = keyAxis->range();
+    const double rangeSize = oldRange.size();
+    if (rangeSize > 0 && qAbs(newRange.size()-rangeSize) <= rangeSize*1e-9)
+    {
+      const double pixelsPerKey = (keyAxis->rangeReversed() ? -1 : 1)*mScrollRect.width()/rangeSize;
+      const double shift = (oldRange.lower-newRange.lower)*pixelsPerKey;
+      dx = qRound(shift);
+      if (qAbs(shift) >= mScrollRect.width() || qAbs(shift-dx) > 0.01)
+        canScroll = false;
+    } else
+      canScroll = false;
+  }
+  
+  mReplotting = true;
+  mReplotQueued = false;
+  emit beforeReplot();
+  
+  updateLayout();
+  QRect scrollRect = axisRect->rect().adjusted(0, -1, 0, 0); // plottables are clipped to the axis rect moved up by one pixel, see QCPLayer::draw
+  QList<QCPRange> axisRanges;
+  foreach (QCPAxis *axis, axes)
+    axisRanges.append(axis->range());
+  
+  if (canScroll)
+  {
+    canScroll = scrollRect == mScrollRect && !hasInvalidatedPaintBuffers();
+    for (int i=0; i<axes.size() && canScroll; ++i)
+    {
+      if (i == keyAxisIndex || (axes.at(i)->orientation() == keyAxis->orientation() && axisRanges.at(i) == keyAxis->range())) // parallel axes coupled to the key axis may move along
+        continue;
+      if (axisRanges.at(i) != mScrollAxisRanges.at(i))
+        canScroll = false;
+    }
+  }
+  QSharedPointer<QCPAbstractPaintBuffer> layerBuffer = layer->mPaintBuffer.toStrongRef();
+  if (canScroll)
+    canScroll = !layerBuffer.isNull() && layerBuffer->size() == viewport().size() && layerBuffer->scroll(dx, 0, scrollRect);
+  
+  if (canScroll)
+  {
+    // redraw the columns exposed by the shift, and those from dirtyFromKey on:
+    const int left = scrollRect.left();
+    const int right = scrollRect.left()+scrollRect.width();
+    int dirtyLeft = right, dirtyRight = left;
+    if (dx < 0)
+    {
+      dirtyLeft = right+dx;
+      dirtyRight = right;
+    } else if (dx > 0)
+    {
+      dirtyLeft = left;
+      dirtyRight = left+dx;
+    }
+    if (!qIsNaN(dirtyFromKey))
+    {
+      // widen the seam by line widths and scatter sizes, so shapes reaching into it are completed:
+      double extent = 1;
+      foreach (QCPLayerable *child, layer->children())
+      {
+        if (QCPAbstractPlottable *plottable = qobject_cast<QCPAbstractPlottable*>(child))
+          extent = qMax(extent, plottable->pen().widthF());
+        if (QCPGraph *graph = qobject_cast<QCPGraph*>(child))
+          extent = qMax(extent, graph->scatterStyle().size());
+      }
+      const int margin = qCeil(extent*0.5)+2;
+      const double dirtyPixel = qBound((double)left, keyAxis->coordToPixel(dirtyFromKey), (double)right);
+      if (keyAxis->rangeReversed())
+      {
+        dirtyLeft = left;
+        dirtyRight = qMax(dirtyRight, qMin(right, qCeil(dirtyPixel)+margin));
+      } else
+      {
+        dirtyLeft = qMin(dirtyLeft, qMax(left, qFloor(dirtyPixel)-margin));
+        dirtyRight = right;
+      }
+    }
+    if (dirtyLeft < dirtyRight)
+      layer->drawToPaintBuffer(QRect(dirtyLeft, scrollRect.top(), dirtyRight-dirtyLeft, scrollRect.height()));
+    
+    if (axisRanges != mScrollAxisRanges) // if no range moved, grid and axes look the same as in the last frame
+    {
+      for (int i=0; i<mPaintBuffers.size(); ++i)
+      {
+        if (mPaintBuffers.at(i) != layerBuffer)
+          mPaintBuffers.at(i)->clear(Qt::transparent);
+      }
+      foreach (QCPLayer *otherLayer, mLayers)
+      {
+        if (otherLayer->mPaintBuffer.data() != layerBuffer.data())
+          otherLayer->drawToPaintBuffer();
+      }
+    }
+  } else
+  {
+    setupPaintBuffers();
+    foreach (QCPLayer *otherLayer, mLayers)
+      otherLayer->drawToPaintBuffer();
+    for (int i=0; i<mPaintBuffers.size(); ++i)
+      mPaintBuffers.at(i)->setInvalidated(false);
+  }
+  
+  mScrollLayer = layer;
+  mScrollKeyAxis = keyAxis;
+  mScrollRect = scrollRect;
+  mScrollAxisRanges = axisRanges;
+  
+  if ((refreshPriority == rpRefreshHint && mPlottingHints.testFlag(QCP::phImmediateRefresh)) || refreshPriority==rpImmediateRefresh)
+    repaint();
+  else if (refreshPriority != rpNoRefresh)
     update();
   
   emit afterReplot();
   mReplotting = false;
 }
 
+/*!
+  Moves the range of \a keyAxis to the nearest whole pixel offset from the frame last drawn by \ref
+  scrollReplot (by at most half a pixel), so the next \ref scrollReplot can shift that frame instead
+  of redrawing it. Call this after setting the new key range and before \ref scrollReplot, on the
+  thread that owns the plot: axes coupled to \a keyAxis via its \ref QCPAxis::rangeChanged signal
+  then follow the snapped range before the frame is drawn.
+
+  Does nothing if the last frame wasn't drawn by \ref scrollReplot with \a keyAxis, if the range
+  size of \a keyAxis changed, or if it moved by a plot width or more.
+*/
+void QCustomPlot::snapScrollRange(QCPAxis *keyAxis)
+{
+  if (!keyAxis || keyAxis != mScrollKeyAxis || !mScrollLayer || mScrollRect.width() <= 0)
+    return;
+  const int keyAxisIndex = keyAxis->axisRect()->axes().indexOf(keyAxis);
+  if (keyAxisIndex < 0 || keyAxisIndex >= mScrollAxisRanges.size())
+    return;
+  
+  const QCPRange oldRange = mScrollAxisRanges.at(keyAxisIndex);
+  const QCPRange newRange = keyAxis->range();
+  const double rangeSize = oldRange.size();
+  if (rangeSize <= 0 || qAbs(newRange.size()-rangeSize) > rangeSize*1e-9)
+    return;
+  const double pixelsPerKey = (keyAxis->rangeReversed() ? -1 : 1)*mScrollRect.width()/rangeSize;
+  const double shift = (oldRange.lower-newRange.lower)*pixelsPerKey;
+  if (qAbs(shift) >= mScrollRect.width())
+    return;
+  const double lower = oldRange.lower-qRound(shift)/pixelsPerKey;
+  if (lower != newRange.lower || newRange.upper != lower+rangeSize)
+    keyAxis->setRange(lower, lower+rangeSize);
+}
+
 /*!
   Rescales the axes such that all plottables (like graphs) in the plot are fully visible.
   
@@ -15118,7 +15502,9 @@ QCPAbstractPaintBuffer *QCustomPlot::createPaintBuffer()
     qDebug() << Q_FUNC_INFO << "OpenGL enabled even though no support for it compiled in, this shouldn't have happened. Falling back to pixmap paint buffer.";
     return new QCPPaintBufferPixmap(viewport().size(), mBufferDevicePixelRatio);
 #endif
-  } else
+  } else if (mPlottingHints.testFlag(QCP::phImageBuffers))
+    return new QCPPaintBufferImage(viewport().size(), mBufferDevicePixelRatio);
+  else
     return new QCPPaintBufferPixmap(viewport().size(), mBufferDevicePixelRatio);
 }
 
@@ -15195,6 +15581,12 @@ bool QCustomPlot::setupOpenGl()
     return false;
   }
   mGlPaintDevice = QSharedPointer<QOpenGLPaintDevice>(new QOpenGLPaintDevice);
+  mGlLineRenderer = new QCPGlLineRenderer(mGlContext.data());
+  if (!mGlLineRenderer->isValid()) // graphs are still drawn through the paint device, just not from vertex buffers
+  {
+    delete mGlLineRenderer;
+    mGlLineRenderer = 0;
+  }
   return true;
 #elif defined(QCP_OPENGL_PBUFFER)
   return QGLFormat::hasOpenGL();
@@ -15217,6 +15609,8 @@ bool QCustomPlot::setupOpenGl()
 void QCustomPlot::freeOpenGl()
 {
 #ifdef QCP_OPENGL_FBO
+  delete mGlLineRenderer; // needs the context, so goes first
+  mGlLineRenderer = 0;
   mGlPaintDevice.clear();
   mGlContext.clear();
   mGlSurface.clear();
@@ -15928,7 +16322,25 @@ void QCPColorGradient::colorize(const double *data, const QCPRange &range, QRgb
       }
     } else
     {
-      for (int i=0; i<n; ++i)
+      int i = 0;
+#ifdef QCP_SSE2
+      // map two data values at once. The index is clamped before the integer conversion, which also sends NaN to
+      // the lowest level (_mm_max_pd returns its second operand if either is NaN):
+      const __m128d lower = _mm_set1_pd(range.lower);
+      const __m128d factor = _mm_set1_pd(posToIndexFactor);
+      const __m128d minIndex = _mm_setzero_pd();
+      const __m128d maxIndex = _mm_set1_pd(mLevelCount-1);
+      const QRgb *colors = mColorBuffer.constData();
+      for (; i+1<n; i+=2)
+      {
+        const __m128d values = _mm_set_pd(data[dataIndexFactor*(i+1)], data[dataIndexFactor*i]);
+        const __m128d positions = _mm_min_pd(_mm_max_pd(_mm_mul_pd(_mm_sub_pd(values, lower), factor), minIndex), maxIndex);
+        const __m128i indices = _mm_cvttpd_epi32(positions);
+        scanLine[i] = colors[_mm_cvtsi128_si32(indices)];
+        scanLine[i+1] = colors[_mm_cvtsi128_si32(_mm_srli_si128(indices, 4))];
+      }
+#endif
+      for (; i<n; ++i)
       {
         int index = (data[dataIndexFactor*i]-range.lower)*posToIndexFactor;
         if (index < 0)
@@ -19993,6 +20405,74 @@ QCPGraphData::QCPGraphData(double key, double value) :
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPAxisPixelTransform
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \internal
+  \class QCPAxisPixelTransform
+  \brief The coordinate to pixel mapping of an axis, evaluated once for many coordinates
+
+  \ref QCPAxis::coordToPixel branches on orientation, scale type and range direction for every
+  call. This helper resolves those branches once for the current axis state, so transforming a
+  batch of coordinates reduces to a multiply-add (linear axes) or a logarithm and a multiply-add
+  (logarithmic axes) per coordinate. The results equal those of \ref QCPAxis::coordToPixel.
+
+  \see QCPGraph::coordsToPixels
+*/
+class QCPAxisPixelTransform
+{
+public:
+  explicit QCPAxisPixelTransform(const QCPAxis *axis);
+  
+  double map(double coord) const;
+  
+  bool logarithmic;
+  double origin, scale, offset; // linear: (coord-origin)*scale+offset, logarithmic: ln(coord/origin)*scale+offset
+  bool negativeDomain; // logarithmic only: whether the range is below zero
+  double wrongSignPixel; // logarithmic only: pixel for coordinates of the sign opposite to the range
+};
+
+QCPAxisPixelTransform::QCPAxisPixelTransform(const QCPAxis *axis) :
+  logarithmic(axis->scaleType() == QCPAxis::stLogarithmic),
+  origin(0),
+  scale(0),
+  offset(0),
+  negativeDomain(axis->range().upper < 0),
+  wrongSignPixel(0)
+{
+  const QCPRange range = axis->range();
+  const QRect rect = axis->axisRect()->rect();
+  const bool reversed = axis->rangeReversed();
+  const bool horizontal = axis->orientation() == Qt::Horizontal;
+  const double length = horizontal ? rect.width() : rect.height();
+  const double span = logarithmic ? qLn(range.upper/range.lower) : range.size();
+  // the pixel direction of increasing coordinates is flipped by vertical orientation and by reversal:
+  scale = (horizontal != reversed ? 1 : -1)*length/span;
+  origin = reversed ? range.upper : range.lower;
+  offset = horizontal ? rect.left() : rect.bottom();
+  if (logarithmic)
+  {
+    if (horizontal)
+      wrongSignPixel = negativeDomain != reversed ? rect.right()+200 : rect.left()-200;
+    else
+      wrongSignPixel = negativeDomain != reversed ? rect.top()-200 : rect.bottom()+200;
+  }
+}
+
+/*!
+  Returns the pixel coordinate of \a coord, like \ref QCPAxis::coordToPixel.
+*/
+inline double QCPAxisPixelTransform::map(double coord) const
+{
+  if (!logarithmic)
+    return (coord-origin)*scale+offset;
+  if (negativeDomain ? coord >= 0.0 : coord <= 0.0) // invalid value for logarithmic scale, just draw it outside visible range
+    return wrongSignPixel;
+  return qLn(coord/origin)*scale+offset;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPGraph
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -20071,10 +20551,16 @@ QCPGraph::QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   setScatterSkip(0);
   setChannelFillGraph(0);
   setAdaptiveSampling(true);
+  setValueTransform(1.0, 0.0);
+  mLineCache.valid = false;
 }
 
 QCPGraph::~QCPGraph()
 {
+#ifdef QCP_OPENGL_FBO
+  if (mParentPlot && mParentPlot->mGlLineRenderer)
+    mParentPlot->mGlLineRenderer->releaseGraph(this);
+#endif
 }
 
 /*! \overload
@@ -20217,6 +20703,26 @@ void QCPGraph::setAdaptiveSampling(bool enabled)
   mAdaptiveSampling = enabled;
 }
 
+/*!
+  Sets an affine transform that is applied to the values of this graph when it is drawn: each data
+  point is displayed at the value <tt>value*scale+offset</tt>. This can be used for unit
+  conversions or to normalize graphs of different magnitude into a common value axis range.
+  
+  The data stored in the container (\ref data) is not modified, so the transform can be changed or
+  reset at any time without losing precision or rewriting the data. The transform is only applied
+  to the points that are actually drawn, after adaptive sampling, so it costs practically nothing
+  even for large data sets. \ref getValueRange (and thus axis rescaling) and \ref selectTest
+  consider the transformed values. Items like QCPItemTracer which read the data directly see the
+  untransformed values.
+  
+  The default is a \a scale of 1 and an \a offset of 0, i.e. no transform.
+*/
+void QCPGraph::setValueTransform(double scale, double offset)
+{
+  mValueScale = scale;
+  mValueOffset = offset;
+}
+
 /*! \overload
   
   Adds the provided points in \a keys and \a values to the current data. The provided vectors
@@ -20233,19 +20739,7 @@ void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &value
 {
   if (keys.size() != values.size())
     qDebug() << Q_FUNC_INFO << "keys and values have different sizes:" << keys.size() << values.size();
-  const int n = qMin(keys.size(), values.size());
-  QVector<QCPGraphData> tempData(n);
-  QVector<QCPGraphData>::iterator it = tempData.begin();
-  const QVector<QCPGraphData>::iterator itEnd = tempData.end();
-  int i = 0;
-  while (it != itEnd)
-  {
-    it->key = keys[i];
-    it->value = values[i];
-    ++it;
-    ++i;
-  }
-  mDataContainer->add(tempData, alreadySorted); // don't modify tempData beyond this to prevent copy on write
+  mDataContainer->add(keys, values, alreadySorted); // writes the columns directly into the container, no interleaved temporary
 }
 
 /*! \overload
@@ -20282,6 +20776,46 @@ double QCPGraph::selectTest(const QPointF &pos, bool onlySelectable, QVariant *d
     return -1;
 }
 
+/*!
+  Selects the data points that are drawn within \a rect. Unlike the base class implementation, this
+  takes the value transformation (see \ref setValueTransform) into account: the value range of \a
+  rect is mapped back to raw data values before they are looked up in the value summary of the data
+  container (see \ref QCPDataContainer::valueSpans).
+
+  \seebaseclassmethod
+*/
+QCPDataSelection QCPGraph::selectTestRect(const QRectF &rect, bool onlySelectable) const
+{
+  if (!hasValueTransform())
+    return QCPAbstractPlottable1D<QCPGraphData>::selectTestRect(rect, onlySelectable);
+  
+  QCPDataSelection result;
+  if ((onlySelectable && mSelectable == QCP::stNone) || mDataContainer->isEmpty())
+    return result;
+  if (!mKeyAxis || !mValueAxis)
+    return result;
+  
+  double key1, value1, key2, value2;
+  pixelsToCoords(rect.topLeft(), key1, value1);
+  pixelsToCoords(rect.bottomRight(), key2, value2);
+  const QCPRange keyRange(key1, key2);
+  QCPRange valueRange;
+  if (mValueScale == 0) // all data points are drawn at mValueOffset, so either all or none of the key range are inside
+  {
+    if (!QCPRange(value1, value2).contains(mValueOffset))
+      return result;
+    valueRange = QCPRange(-std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+  } else
+    valueRange = QCPRange((value1-mValueOffset)/mValueScale, (value2-mValueOffset)/mValueScale); // QCPRange normalizes, so negative scales don't matter
+  
+  QVector<QCPDataRange> spans;
+  mDataContainer->valueSpans(mDataContainer->findBegin(keyRange.lower, false), mDataContainer->findEnd(keyRange.upper, false), valueRange, spans);
+  for (int i=0; i<spans.size(); ++i)
+    result.addDataRange(spans.at(i), false);
+  result.simplify();
+  return result;
+}
+
 /* inherits documentation from base class */
 QCPRange QCPGraph::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain) const
 {
@@ -20291,7 +20825,41 @@ QCPRange QCPGraph::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain) c
 /* inherits documentation from base class */
 QCPRange QCPGraph::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain, const QCPRange &inKeyRange) const
 {
-  return mDataContainer->valueRange(foundRange, inSignDomain, inKeyRange);
+  if (!hasValueTransform())
+    return mDataContainer->valueRange(foundRange, inSignDomain, inKeyRange);
+  
+  if (inSignDomain == QCP::sdBoth || (mValueOffset == 0 && mValueScale != 0)) // the transformed range follows from the range of the raw values
+  {
+    QCP::SignDomain rawSignDomain = inSignDomain;
+    if (mValueScale < 0 && inSignDomain != QCP::sdBoth) // a negative scale swaps the sign domains
+      rawSignDomain = inSignDomain == QCP::sdPositive ? QCP::sdNegative : QCP::sdPositive;
+    const QCPRange rawRange = mDataContainer->valueRange(foundRange, rawSignDomain, inKeyRange);
+    return foundRange ? QCPRange(transformedValue(rawRange.lower), transformedValue(rawRange.upper)) : QCPRange();
+  }
+  
+  // an offset moves values across zero, so the sign restricted range needs the transformed value of each point:
+  QCPGraphDataContainer::const_iterator itBegin = mDataContainer->constBegin();
+  QCPGraphDataContainer::const_iterator itEnd = mDataContainer->constEnd();
+  if (inKeyRange != QCPRange())
+  {
+    itBegin = mDataContainer->findBegin(inKeyRange.lower, false);
+    itEnd = mDataContainer->findEnd(inKeyRange.upper, false);
+  }
+  QCPRange range;
+  foundRange = false;
+  for (QCPGraphDataContainer::const_iterator it = itBegin; it != itEnd; ++it)
+  {
+    const double value = transformedValue(it->value);
+    if (qIsNaN(value) || (inSignDomain == QCP::sdPositive ? value <= 0 : value >= 0))
+      continue;
+    if (!foundRange)
+    {
+      range = QCPRange(value, value);
+      foundRange = true;
+    } else
+      range.expand(value);
+  }
+  return range;
 }
 
 /* inherits documentation from base class */
@@ -20300,18 +20868,26 @@ void QCPGraph::draw(QCPPainter *painter)
   if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
   if (mKeyAxis.data()->range().size() <= 0 || mDataContainer->isEmpty()) return;
   if (mLineStyle == lsNone && mScatterStyle.isNone()) return;
-  
-  QVector<QPointF> lines, scatters; // line and (if necessary) scatter pixel coordinates will be stored here while iterating over segments
+#ifdef QCP_OPENGL_FBO
+  if (mParentPlot->mGlLineRenderer && mParentPlot->plottingHints().testFlag(QCP::phGlLines) && mParentPlot->mGlLineRenderer->drawGraph(painter, this))
+    return;
+#endif
+  
+  QVector<QPointF> lines, scatters; // line and (if necessary) scatter pixel coordinates will be stored here while iterating over segments
   
   // loop over and draw segments of unselected/selected data:
   QList<QCPDataRange> selectedSegments, unselectedSegments, allSegments;
   getDataSegments(selectedSegments, unselectedSegments);
   allSegments << unselectedSegments << selectedSegments;
+  const QCPDataRange clipDataRange = getClipDataRange(painter); // only the data of a clipped strip, see QCustomPlot::scrollReplot
+  const bool cachedLines = mLineStyle == lsLine && selectedSegments.isEmpty(); // getCachedLines is cheaper than building the strip's lines
   for (int i=0; i<allSegments.size(); ++i)
   {
     bool isSelectedSegment = i >= unselectedSegments.size();
     // get line pixel points appropriate to line style:
     QCPDataRange lineDataRange = isSelectedSegment ? allSegments.at(i) : allSegments.at(i).adjusted(-1, 1); // unselected segments extend lines to bordering selected data point (safe to exceed total data bounds in first/last segment, getLines takes care)
+    if (!cachedLines)
+      lineDataRange = lineDataRange.intersection(clipDataRange);
     getLines(&lines, lineDataRange);
     
     // check data validity if flag set:
@@ -20352,7 +20928,7 @@ void QCPGraph::draw(QCPPainter *painter)
       finalScatterStyle = mSelectionDecorator->getFinalScatterStyle(mScatterStyle);
     if (!finalScatterStyle.isNone())
     {
-      getScatters(&scatters, allSegments.at(i));
+      getScatters(&scatters, allSegments.at(i).intersection(clipDataRange));
       drawScatterPlot(painter, scatters, finalScatterStyle);
     }
   }
@@ -20427,10 +21003,14 @@ void QCPGraph::getLines(QVector<QPointF> *lines, const QCPDataRange &dataRange)
     lines->clear();
     return;
   }
+  if (mLineStyle == lsLine && dataRange.begin() <= 0 && dataRange.end() >= dataCount() && getCachedLines(lines, begin, end))
+    return;
   
   QVector<QCPGraphData> lineData;
   if (mLineStyle != lsNone)
     getOptimizedLineData(&lineData, begin, end);
+  if (hasValueTransform())
+    applyValueTransform(&lineData);
   
   if (mKeyAxis->rangeReversed() != (mKeyAxis->orientation() == Qt::Vertical)) // make sure key pixels are sorted ascending in lineData (significantly simplifies following processing)
     std::reverse(lineData.begin(), lineData.end());
@@ -20446,6 +21026,129 @@ void QCPGraph::getLines(QVector<QPointF> *lines, const QCPDataRange &dataRange)
   }
 }
 
+/*! \internal
+
+  Provides the result of \ref getLines for the line style \ref lsLine over the visible data points
+  from \a begin up to (but not including) \a end, keeping the pixel polyline between calls.
+
+  Compared to the polyline of the previous call, the cache is
+  \li reused if the axes and data didn't change,
+  \li translated if the axis ranges were only moved (e.g. a strip chart following new data),
+  \li extended if data points came into view at the high key end (appended data, or data scrolling
+  in). Only the last pixel interval of the adaptive sampling is computed again, since its points may
+  change with the data following it (see \ref getAdaptiveLineData).
+
+  It is rebuilt completely if the axis scales, the axis rect, the value transform, the adaptive
+  sampling decision or the data (other than by appending, see \ref QCPDataContainer::revision)
+  changed, if data came into view at the low key end, or if more than half of the cached points
+  have scrolled out of view. So the replot cost of a strip chart at a constant zoom level is
+  proportional to the number of new data points instead of the number of visible pixels.
+
+  Returns false without touching \a lines if the cache can't be used: for logarithmic axes and if
+  the key pixels descend with the keys. Note that the cache samples the data like \ref
+  getOptimizedLineData without calling it, so reimplementations of that method are bypassed.
+*/
+bool QCPGraph::getCachedLines(QVector<QPointF> *lines, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end) const
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (keyAxis->scaleType() != QCPAxis::stLinear || valueAxis->scaleType() != QCPAxis::stLinear)
+    return false;
+  if (keyAxis->rangeReversed() != (keyAxis->orientation() == Qt::Vertical)) // getLines would reverse the line data
+    return false;
+  
+  LineCache &cache = mLineCache;
+  const QCPRange keyRange = keyAxis->range();
+  const QCPRange valueRange = valueAxis->range();
+  const QRect axisRect = keyAxis->axisRect()->rect();
+  const bool adaptive = useAdaptiveLineSampling(begin, end);
+  const int storageBegin = mDataContainer->storageOffset()+int(begin-mDataContainer->constBegin());
+  const int storageEnd = mDataContainer->storageOffset()+int(end-mDataContainer->constBegin());
+  
+  bool reuse = cache.valid && cache.data.toStrongRef() == mDataContainer && cache.revision == mDataContainer->revision() &&
+      cache.adaptive == adaptive && cache.valueScale == mValueScale && cache.valueOffset == mValueOffset && cache.axisRect == axisRect &&
+      cache.keyReversed == keyAxis->rangeReversed() && cache.valueReversed == valueAxis->rangeReversed() &&
+      qAbs(keyRange.size()-cache.keySize) <= cache.keySize*1e-9 && qAbs(valueRange.size()-cache.valueSize) <= cache.valueSize*1e-9 &&
+      storageBegin >= cache.begin && storageBegin-cache.begin <= (cache.end-cache.begin)/2 && cache.tailBegin >= mDataContainer->storageOffset();
+  if (reuse)
+  {
+    // translate the cached pixels by the movement of the axis ranges:
+    const double keyShift = keyAxis->coordToPixel(cache.keyLower)-cache.keyLowerPixel;
+    const double valueShift = valueAxis->coordToPixel(cache.valueLower)-cache.valueLowerPixel;
+    if (keyShift != 0 || valueShift != 0)
+    {
+      const QPointF shift = keyAxis->orientation() == Qt::Horizontal ? QPointF(keyShift, valueShift) : QPointF(valueShift, keyShift);
+      QPointF *point = cache.lines.data();
+      QPointF *pointEnd = point+cache.lines.size();
+      for (; point != pointEnd; ++point)
+        *point += shift;
+    }
+    // resample from the last, possibly incomplete pixel interval to the new visible end:
+    if (storageEnd > cache.end)
+    {
+      QVector<QCPGraphData> lineData;
+      const QCPGraphDataContainer::const_iterator tail = mDataContainer->constBegin()+(cache.tailBegin-mDataContainer->storageOffset());
+      QCPGraphDataContainer::const_iterator lastIntervalBegin = end;
+      int lastIntervalIndex = 0;
+      if (adaptive)
+        getAdaptiveLineData(&lineData, tail, end, cache.tailPreviousKey, &lastIntervalBegin, &lastIntervalIndex);
+      else
+      {
+        lineData.resize(end-tail);
+        std::copy(tail, end, lineData.begin());
+        lastIntervalIndex = lineData.size();
+      }
+      if (hasValueTransform())
+        applyValueTransform(&lineData);
+      cache.lines.resize(cache.tailLines+lineData.size());
+      coordsToPixels(lineData.constData(), lineData.constData()+lineData.size(), cache.lines.data()+cache.tailLines);
+      if (lastIntervalBegin != tail)
+        cache.tailPreviousKey = (lastIntervalBegin-1)->key;
+      cache.tailBegin = mDataContainer->storageOffset()+int(lastIntervalBegin-mDataContainer->constBegin());
+      cache.tailLines += lastIntervalIndex;
+      cache.end = storageEnd;
+    }
+  } else
+  {
+    QVector<QCPGraphData> lineData;
+    QCPGraphDataContainer::const_iterator lastIntervalBegin = end;
+    int lastIntervalIndex = 0;
+    if (adaptive)
+      getAdaptiveLineData(&lineData, begin, end, qQNaN(), &lastIntervalBegin, &lastIntervalIndex);
+    else
+    {
+      lineData.resize(end-begin);
+      std::copy(begin, end, lineData.begin());
+      lastIntervalIndex = lineData.size();
+    }
+    if (hasValueTransform())
+      applyValueTransform(&lineData);
+    cache.lines = dataToLines(lineData);
+    cache.valid = true;
+    cache.data = mDataContainer;
+    cache.revision = mDataContainer->revision();
+    cache.begin = storageBegin;
+    cache.end = storageEnd;
+    cache.tailBegin = mDataContainer->storageOffset()+int(lastIntervalBegin-mDataContainer->constBegin());
+    cache.tailLines = lastIntervalIndex;
+    cache.tailPreviousKey = lastIntervalBegin != begin ? (lastIntervalBegin-1)->key : qQNaN();
+    cache.adaptive = adaptive;
+    cache.valueScale = mValueScale;
+    cache.valueOffset = mValueOffset;
+    cache.axisRect = axisRect;
+    cache.keyReversed = keyAxis->rangeReversed();
+    cache.valueReversed = valueAxis->rangeReversed();
+    cache.keySize = keyRange.size();
+    cache.valueSize = valueRange.size();
+  }
+  cache.keyLower = keyRange.lower;
+  cache.keyLowerPixel = keyAxis->coordToPixel(keyRange.lower);
+  cache.valueLower = valueRange.lower;
+  cache.valueLowerPixel = valueAxis->coordToPixel(valueRange.lower);
+  *lines = cache.lines; // shared until one of them is modified
+  return true;
+}
+
 /*! \internal
 
   This method retrieves an optimized set of data points via \ref getOptimizedScatterData and then
@@ -20475,34 +21178,36 @@ void QCPGraph::getScatters(QVector<QPointF> *scatters, const QCPDataRange &dataR
   
   QVector<QCPGraphData> data;
   getOptimizedScatterData(&data, begin, end);
+  if (hasValueTransform())
+    applyValueTransform(&data);
   
   if (mKeyAxis->rangeReversed() != (mKeyAxis->orientation() == Qt::Vertical)) // make sure key pixels are sorted ascending in data (significantly simplifies following processing)
     std::reverse(data.begin(), data.end());
   
   scatters->resize(data.size());
-  if (keyAxis->orientation() == Qt::Vertical)
-  {
-    for (int i=0; i<data.size(); ++i)
-    {
-      if (!qIsNaN(data.at(i).value))
-      {
-        (*scatters)[i].setX(valueAxis->coordToPixel(data.at(i).value));
-        (*scatters)[i].setY(keyAxis->coordToPixel(data.at(i).key));
-      }
-    }
-  } else
+  coordsToPixels(data.constData(), data.constData()+data.size(), scatters->data());
+  for (int i=0; i<data.size(); ++i)
   {
-    for (int i=0; i<data.size(); ++i)
-    {
-      if (!qIsNaN(data.at(i).value))
-      {
-        (*scatters)[i].setX(keyAxis->coordToPixel(data.at(i).key));
-        (*scatters)[i].setY(valueAxis->coordToPixel(data.at(i).value));
-      }
-    }
+    if (qIsNaN(data.at(i).value)) // NaN values keep the default point
+      (*scatters)[i] = QPointF();
   }
 }
 
+/*! \internal
+
+  Replaces the values of the points in \a data by the values they are displayed at, according to
+  the value transform (\ref setValueTransform). \a data is usually the output of \ref
+  getOptimizedLineData or \ref getOptimizedScatterData, so only the points that are drawn are
+  transformed. NaN values stay NaN.
+*/
+void QCPGraph::applyValueTransform(QVector<QCPGraphData> *data) const
+{
+  QCPGraphData *it = data->data();
+  QCPGraphData *itEnd = it+data->size();
+  for (; it != itEnd; ++it)
+    it->value = transformedValue(it->value);
+}
+
 /*! \internal
 
   Takes raw data points in plot coordinates as \a data, and returns a vector containing pixel
@@ -20523,22 +21228,81 @@ QVector<QPointF> QCPGraph::dataToLines(const QVector<QCPGraphData> &data) const
   result.resize(data.size());
   
   // transform data points to pixels:
-  if (keyAxis->orientation() == Qt::Vertical)
+  coordsToPixels(data.constData(), data.constData()+data.size(), result.data());
+  return result;
+}
+
+/*! \internal
+
+  Transforms the data points from \a begin up to (but not including) \a end to pixel coordinates
+  and writes them to \a pixels, which must have room for <tt>end-begin</tt> points. The result
+  equals calling \ref QCPAxis::coordToPixel of the key and value axis for every data point, but
+  the axis parameters are resolved only once (see \ref QCPAxisPixelTransform).
+
+  If both axes are linear, each data point is mapped with a single multiply-add of its key/value
+  pair as one SSE2 vector, where available. Otherwise a scalar loop is used, which for logarithmic
+  axes evaluates one logarithm per coordinate.
+*/
+void QCPGraph::coordsToPixels(const QCPGraphData *begin, const QCPGraphData *end, QPointF *pixels) const
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  
+  const QCPAxisPixelTransform keyTransform(keyAxis);
+  const QCPAxisPixelTransform valueTransform(valueAxis);
+  const bool keyIsVertical = keyAxis->orientation() == Qt::Vertical;
+  const int count = int(end-begin);
+  if (count <= 0)
+    return;
+  
+#ifdef QCP_SSE2
+  if (!keyTransform.logarithmic && !valueTransform.logarithmic && sizeof(qreal) == sizeof(double))
+  {
+    // QCPGraphData is {key, value} and QPointF is {x, y}, both as two adjacent doubles. Lane 0
+    // receives the coordinate that becomes x, lane 1 the one that becomes y:
+    const QCPAxisPixelTransform &xTransform = keyIsVertical ? valueTransform : keyTransform;
+    const QCPAxisPixelTransform &yTransform = keyIsVertical ? keyTransform : valueTransform;
+    const __m128d origin = _mm_set_pd(yTransform.origin, xTransform.origin);
+    const __m128d scale = _mm_set_pd(yTransform.scale, xTransform.scale);
+    const __m128d offset = _mm_set_pd(yTransform.offset, xTransform.offset);
+    const double *source = &begin->key;
+    double *target = reinterpret_cast<double*>(pixels);
+    if (keyIsVertical)
+    {
+      for (int i=0; i<count; ++i)
+      {
+        __m128d coords = _mm_loadu_pd(source+2*i);
+        coords = _mm_shuffle_pd(coords, coords, 1); // swap to {value, key}
+        _mm_storeu_pd(target+2*i, _mm_add_pd(_mm_mul_pd(_mm_sub_pd(coords, origin), scale), offset));
+      }
+    } else
+    {
+      for (int i=0; i<count; ++i)
+      {
+        const __m128d coords = _mm_loadu_pd(source+2*i);
+        _mm_storeu_pd(target+2*i, _mm_add_pd(_mm_mul_pd(_mm_sub_pd(coords, origin), scale), offset));
+      }
+    }
+    return;
+  }
+#endif
+  
+  if (keyIsVertical)
   {
-    for (int i=0; i<data.size(); ++i)
+    for (int i=0; i<count; ++i)
     {
-      result[i].setX(valueAxis->coordToPixel(data.at(i).value));
-      result[i].setY(keyAxis->coordToPixel(data.at(i).key));
+      pixels[i].setX(valueTransform.map(begin[i].value));
+      pixels[i].setY(keyTransform.map(begin[i].key));
     }
   } else // key axis is horizontal
   {
-    for (int i=0; i<data.size(); ++i)
+    for (int i=0; i<count; ++i)
     {
-      result[i].setX(keyAxis->coordToPixel(data.at(i).key));
-      result[i].setY(valueAxis->coordToPixel(data.at(i).value));
+      pixels[i].setX(keyTransform.map(begin[i].key));
+      pixels[i].setY(valueTransform.map(begin[i].value));
     }
   }
-  return result;
 }
 
 /*! \internal
@@ -20857,75 +21621,106 @@ void QCPGraph::getOptimizedLineData(QVector<QCPGraphData> *lineData, const QCPGr
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
   if (begin == end) return;
   
-  int dataCount = end-begin;
-  int maxCount = std::numeric_limits<int>::max();
-  if (mAdaptiveSampling)
+  if (useAdaptiveLineSampling(begin, end)) // use adaptive sampling only if there are at least two points per pixel on average
   {
-    double keyPixelSpan = qAbs(keyAxis->coordToPixel(begin->key)-keyAxis->coordToPixel((end-1)->key));
-    if (2*keyPixelSpan+2 < (double)std::numeric_limits<int>::max())
-      maxCount = 2*keyPixelSpan+2;
+    QCPGraphDataContainer::const_iterator lastIntervalBegin;
+    int lastIntervalIndex;
+    getAdaptiveLineData(lineData, begin, end, qQNaN(), &lastIntervalBegin, &lastIntervalIndex);
+  } else // don't use adaptive sampling algorithm, transfer points one-to-one from the data container into the output
+  {
+    lineData->resize(end-begin);
+    std::copy(begin, end, lineData->begin());
   }
+}
+
+/*! \internal
+
+  Returns whether \ref getOptimizedLineData applies adaptive sampling to the data points from \a
+  begin up to (but not including) \a end. This is the case if \ref setAdaptiveSampling is enabled
+  and there are at least two data points per pixel on average.
+*/
+bool QCPGraph::useAdaptiveLineSampling(const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end) const
+{
+  if (!mAdaptiveSampling || begin == end)
+    return false;
+  QCPAxis *keyAxis = mKeyAxis.data();
+  int maxCount = std::numeric_limits<int>::max();
+  double keyPixelSpan = qAbs(keyAxis->coordToPixel(begin->key)-keyAxis->coordToPixel((end-1)->key));
+  if (2*keyPixelSpan+2 < (double)std::numeric_limits<int>::max())
+    maxCount = 2*keyPixelSpan+2;
+  return end-begin >= maxCount;
+}
+
+/*! \internal
+
+  The adaptive sampling of \ref getOptimizedLineData: appends to \a lineData a few points per
+  pixel interval of the key axis for the data points from \a begin up to (but not including) \a
+  end, preserving the value span of each interval.
+
+  The output of an interval depends on its own data points, on the key of the data point before it
+  (\a lastIntervalEndKey, NaN if \a begin starts the sampled range) and on whether more data follows
+  it. So only the points of the last interval may change if data is appended later. Its first data
+  point is returned in \a lastIntervalBegin and the index in \a lineData where its points start in
+  \a lastIntervalIndex, so the sampling can be resumed there (see \ref getCachedLines).
+*/
+void QCPGraph::getAdaptiveLineData(QVector<QCPGraphData> *lineData, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end, double lastIntervalEndKey,
+                                   QCPGraphDataContainer::const_iterator *lastIntervalBegin, int *lastIntervalIndex) const
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  *lastIntervalBegin = begin;
+  *lastIntervalIndex = lineData->size();
+  if (begin == end)
+    return;
   
-  if (mAdaptiveSampling && dataCount >= maxCount) // use adaptive sampling only if there are at least two points per pixel on average
-  {
-    QCPGraphDataContainer::const_iterator it = begin;
-    double minValue = it->value;
-    double maxValue = it->value;
-    QCPGraphDataContainer::const_iterator currentIntervalFirstPoint = it;
-    int reversedFactor = keyAxis->pixelOrientation(); // is used to calculate keyEpsilon pixel into the correct direction
-    int reversedRound = reversedFactor==-1 ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
-    double currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(begin->key)+reversedRound));
-    double lastIntervalEndKey = currentIntervalStartKey;
-    double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
-    bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
-    int intervalDataCount = 1;
-    ++it; // advance iterator to second data point because adaptive sampling works in 1 point retrospect
-    while (it != end)
-    {
-      if (it->key < currentIntervalStartKey+keyEpsilon) // data point is still within same pixel, so skip it and expand value span of this cluster if necessary
-      {
-        if (it->value < minValue)
-          minValue = it->value;
-        else if (it->value > maxValue)
-          maxValue = it->value;
-        ++intervalDataCount;
-      } else // new pixel interval started
-      {
-        if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
-        {
-          if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point is further away, so first point of this cluster must be at a real data point
-            lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.2, currentIntervalFirstPoint->value));
-          lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
-          lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
-          if (it->key > currentIntervalStartKey+keyEpsilon*2) // new pixel started further away from previous cluster, so make sure the last point of the cluster is at a real data point
-            lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.8, (it-1)->value));
-        } else
-          lineData->append(QCPGraphData(currentIntervalFirstPoint->key, currentIntervalFirstPoint->value));
-        lastIntervalEndKey = (it-1)->key;
-        minValue = it->value;
-        maxValue = it->value;
-        currentIntervalFirstPoint = it;
-        currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(it->key)+reversedRound));
-        if (keyEpsilonVariable)
-          keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
-        intervalDataCount = 1;
-      }
-      ++it;
-    }
-    // handle last interval:
-    if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
+  QCPGraphDataContainer::const_iterator currentIntervalFirstPoint = begin;
+  int reversedFactor = keyAxis->pixelOrientation(); // is used to calculate keyEpsilon pixel into the correct direction
+  int reversedRound = reversedFactor==-1 ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
+  double currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(begin->key)+reversedRound));
+  if (qIsNaN(lastIntervalEndKey))
+    lastIntervalEndKey = currentIntervalStartKey;
+  double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
+  bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
+  // instead of visiting every data point, jump from pixel interval to pixel interval. The interval
+  // end is found by an exponential search followed by a binary search, and the value span of the
+  // interval is taken from the block summary of the data container, so the cost scales with the
+  // number of pixels, not the number of data points:
+  while (currentIntervalFirstPoint != end)
+  {
+    *lastIntervalBegin = currentIntervalFirstPoint;
+    *lastIntervalIndex = lineData->size();
+    const QCPGraphData intervalEndData(currentIntervalStartKey+keyEpsilon, 0);
+    QCPGraphDataContainer::const_iterator searchBegin = currentIntervalFirstPoint+1;
+    int step = 1;
+    while (end-searchBegin > step && (searchBegin+step)->key < intervalEndData.key)
+    {
+      searchBegin += step;
+      step *= 2;
+    }
+    QCPGraphDataContainer::const_iterator searchEnd = end-searchBegin > step ? searchBegin+step+1 : end;
+    QCPGraphDataContainer::const_iterator nextIntervalFirstPoint = std::lower_bound(searchBegin, searchEnd, intervalEndData, qcpLessThanSortKey<QCPGraphData>);
+    
+    if (nextIntervalFirstPoint-currentIntervalFirstPoint >= 2) // pixel has multiple data points, consolidate them to a cluster
     {
-      if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point wasn't a cluster, so first point of this cluster must be at a real data point
+      bool foundRange = false;
+      QCPRange valueSpan = mDataContainer->valueRange(currentIntervalFirstPoint, nextIntervalFirstPoint, foundRange);
+      if (!foundRange)
+        valueSpan = QCPRange(currentIntervalFirstPoint->value, currentIntervalFirstPoint->value);
+      if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point is further away, so first point of this cluster must be at a real data point
         lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.2, currentIntervalFirstPoint->value));
-      lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
-      lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
+      lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.25, valueSpan.lower));
+      lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.75, valueSpan.upper));
+      if (nextIntervalFirstPoint != end && nextIntervalFirstPoint->key > currentIntervalStartKey+keyEpsilon*2) // new pixel started further away from previous cluster, so make sure the last point of the cluster is at a real data point
+        lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.8, (nextIntervalFirstPoint-1)->value));
     } else
       lineData->append(QCPGraphData(currentIntervalFirstPoint->key, currentIntervalFirstPoint->value));
     
-  } else // don't use adaptive sampling algorithm, transfer points one-to-one from the data container into the output
-  {
-    lineData->resize(dataCount);
-    std::copy(begin, end, lineData->begin());
+    if (nextIntervalFirstPoint == end)
+      break;
+    lastIntervalEndKey = (nextIntervalFirstPoint-1)->key;
+    currentIntervalFirstPoint = nextIntervalFirstPoint;
+    currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(currentIntervalFirstPoint->key)+reversedRound));
+    if (keyEpsilonVariable)
+      keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
   }
 }
 
@@ -20970,6 +21765,21 @@ void QCPGraph::getOptimizedScatterData(QVector<QCPGraphData> *scatterData, QCPGr
   {
     double valueMaxRange = valueAxis->range().upper;
     double valueMinRange = valueAxis->range().lower;
+    if (hasValueTransform()) // the data values are compared untransformed, so map the visible range back through the value transform
+    {
+      if (mValueScale != 0)
+      {
+        valueMinRange = (valueMinRange-mValueOffset)/mValueScale;
+        valueMaxRange = (valueMaxRange-mValueOffset)/mValueScale;
+        if (mValueScale < 0)
+          qSwap(valueMinRange, valueMaxRange);
+      } else // all points are displayed at the offset, visible or not regardless of their value
+      {
+        const bool offsetVisible = valueAxis->range().contains(mValueOffset);
+        valueMinRange = offsetVisible ? -std::numeric_limits<double>::max() : std::numeric_limits<double>::max();
+        valueMaxRange = offsetVisible ? std::numeric_limits<double>::max() : -std::numeric_limits<double>::max();
+      }
+    }
     QCPGraphDataContainer::const_iterator it = begin;
     int itIndex = beginIndex;
     double minValue = it->value;
@@ -21017,7 +21827,7 @@ void QCPGraph::getOptimizedScatterData(QVector<QCPGraphData> *scatterData, QCPGr
         if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them
         {
           // determine value pixel span and add as many points in interval to maintain certain vertical data density (this is specific to scatter plot):
-          double valuePixelSpan = qAbs(valueAxis->coordToPixel(minValue)-valueAxis->coordToPixel(maxValue));
+          double valuePixelSpan = qAbs(valueAxis->coordToPixel(transformedValue(minValue))-valueAxis->coordToPixel(transformedValue(maxValue)));
           int dataModulo = qMax(1, qRound(intervalDataCount/(valuePixelSpan/4.0))); // approximately every 4 value pixels one data point on average
           QCPGraphDataContainer::const_iterator intervalIt = currentIntervalStart;
           int c = 0;
@@ -21060,7 +21870,7 @@ void QCPGraph::getOptimizedScatterData(QVector<QCPGraphData> *scatterData, QCPGr
     if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them
     {
       // determine value pixel span and add as many points in interval to maintain certain vertical data density (this is specific to scatter plot):
-      double valuePixelSpan = qAbs(valueAxis->coordToPixel(minValue)-valueAxis->coordToPixel(maxValue));
+      double valuePixelSpan = qAbs(valueAxis->coordToPixel(transformedValue(minValue))-valueAxis->coordToPixel(transformedValue(maxValue)));
       int dataModulo = qMax(1, qRound(intervalDataCount/(valuePixelSpan/4.0))); // approximately every 4 value pixels one data point on average
       QCPGraphDataContainer::const_iterator intervalIt = currentIntervalStart;
       int intervalItIndex = intervalIt-mDataContainer->constBegin();
@@ -21141,6 +21951,48 @@ void QCPGraph::getVisibleDataBounds(QCPGraphDataContainer::const_iterator &begin
   }
 }
 
+/*!  \internal
+  
+  Returns the range of data points that can affect the pixels within the clip region of \a
+  painter: those whose keys lie in the key span of the clip region, widened by the pen width and
+  scatter size, plus one data point beyond each side so lines crossing the borders are complete.
+
+  If the clip region spans the whole axis rect along the key axis (a normal replot), or if a
+  channel fill is set (its polygon needs the lines of both graphs over the same range), all data
+  points are returned. When \ref QCustomPlot::scrollReplot only redraws a strip of the axis rect,
+  this keeps the cost of \ref draw proportional to the data within the strip.
+*/
+QCPDataRange QCPGraph::getClipDataRange(const QCPPainter *painter) const
+{
+  const QCPDataRange allData(0, dataCount());
+  QCPAxis *keyAxis = mKeyAxis.data();
+  if (!painter->hasClipping() || mChannelFillGraph)
+    return allData;
+  
+  const QRectF clip = painter->clipBoundingRect();
+  const QRect axisRect = keyAxis->axisRect()->rect();
+  const bool horizontal = keyAxis->orientation() == Qt::Horizontal;
+  const double clipLower = horizontal ? clip.left() : clip.top();
+  const double clipUpper = horizontal ? clip.right() : clip.bottom();
+  if (clipLower <= (horizontal ? axisRect.left() : axisRect.top()) && clipUpper >= (horizontal ? axisRect.right() : axisRect.bottom()))
+    return allData;
+  
+  // data points just outside the clip may still reach into it with their line joins or scatters:
+  double extent = mPen.widthF();
+  if (mSelectionDecorator)
+    extent = qMax(extent, mSelectionDecorator->pen().widthF());
+  if (!mScatterStyle.isNone())
+    extent = qMax(extent, mScatterStyle.size());
+  const double margin = qCeil(extent*0.5)+2;
+  double key1 = keyAxis->pixelToCoord(clipLower-margin);
+  double key2 = keyAxis->pixelToCoord(clipUpper+margin);
+  if (key1 > key2)
+    qSwap(key1, key2);
+  QCPGraphDataContainer::const_iterator begin = mDataContainer->findBegin(key1, true);
+  QCPGraphDataContainer::const_iterator end = mDataContainer->findEnd(key2, true);
+  return QCPDataRange(begin-mDataContainer->constBegin(), end-mDataContainer->constBegin());
+}
+
 /*!  \internal
   
   This method goes through the passed points in \a lineData and returns a list of the segments
@@ -21574,6 +22426,15 @@ int QCPGraph::findIndexAboveY(const QVector<QPointF> *data, double y) const
   
   If either the graph has no data or if the line style is \ref lsNone and the scatter style's shape
   is \ref QCPScatterStyle::ssNone (i.e. there is no visual representation of the graph), returns -1.0.
+  
+  Only the data within the selection tolerance of \a pixelPoint along the key axis is considered.
+  Within that key range, the closest data point is found without visiting every data point: the
+  search starts with the data points whose values lie within the selection tolerance and widens
+  the value window only as far as needed, looking the candidates up in the value summary of the
+  data container (see \ref QCPDataContainer::valueSpans). Likewise, only the line segments within
+  the key range are tested. So if no part of the graph is within the selection tolerance, the
+  returned distance may be larger than the true distance to the graph, but it is still larger than
+  the selection tolerance.
 */
 double QCPGraph::pointDistance(const QPointF &pixelPoint, QCPGraphDataContainer::const_iterator &closestData) const
 {
@@ -21591,25 +22452,50 @@ double QCPGraph::pointDistance(const QPointF &pixelPoint, QCPGraphDataContainer:
   pixelsToCoords(pixelPoint+QPointF(mParentPlot->selectionTolerance(), mParentPlot->selectionTolerance()), posKeyMax, dummy);
   if (posKeyMin > posKeyMax)
     qSwap(posKeyMin, posKeyMax);
-  // iterate over found data points and then choose the one with the shortest distance to pos:
   QCPGraphDataContainer::const_iterator begin = mDataContainer->findBegin(posKeyMin, true);
   QCPGraphDataContainer::const_iterator end = mDataContainer->findEnd(posKeyMax, true);
-  for (QCPGraphDataContainer::const_iterator it=begin; it!=end; ++it)
+  bool foundRange;
+  const QCPRange valueRange = mDataContainer->valueRange(begin, end, foundRange);
+  if (foundRange)
   {
-    const double currentDistSqr = QCPVector2D(coordsToPixels(it->key, it->value)-pixelPoint).lengthSquared();
-    if (currentDistSqr < minDistSqr)
-    {
-      minDistSqr = currentDistSqr;
-      closestData = it;
+    // test the data points within a window of radius pixels around pos along the value axis. All others are farther
+    // away than radius, so once a data point within radius is found, it is the closest one:
+    const double valuePixel = mValueAxis->orientation() == Qt::Horizontal ? pixelPoint.x() : pixelPoint.y();
+    double radius = qMax(1.0, mParentPlot->selectionTolerance());
+    QVector<QCPDataRange> spans;
+    while (true)
+    {
+      const QCPRange window = valueWindow(valuePixel, radius);
+      spans.clear();
+      mDataContainer->valueSpans(begin, end, window, spans);
+      for (int i=0; i<spans.size(); ++i)
+      {
+        QCPGraphDataContainer::const_iterator it = mDataContainer->constBegin()+spans.at(i).begin();
+        QCPGraphDataContainer::const_iterator itEnd = mDataContainer->constBegin()+spans.at(i).end();
+        for (; it!=itEnd; ++it)
+        {
+          const double currentDistSqr = QCPVector2D(coordsToPixels(it->key, transformedValue(it->value))-pixelPoint).lengthSquared();
+          if (currentDistSqr < minDistSqr)
+          {
+            minDistSqr = currentDistSqr;
+            closestData = it;
+          }
+        }
+      }
+      if (minDistSqr <= radius*radius || (window.lower <= valueRange.lower && window.upper >= valueRange.upper) || qIsInf(radius))
+        break;
+      // widen the window, just enough to be sure about the closest data point if one was found outside radius:
+      radius = closestData != mDataContainer->constEnd() ? qSqrt(minDistSqr) : radius*4;
     }
   }
     
   // calculate distance to graph line if there is one (if so, will probably be smaller than distance to closest data point):
   if (mLineStyle != lsNone)
   {
-    // line displayed, calculate distance to line segments:
+    // line displayed, calculate distance to the line segments in the key range (begin and end already include the
+    // data points just outside, so the segments crossing its borders are part of it):
     QVector<QPointF> lineData;
-    getLines(&lineData, QCPDataRange(0, dataCount()));
+    getLines(&lineData, QCPDataRange(begin-mDataContainer->constBegin(), end-mDataContainer->constBegin()));
     QCPVector2D p(pixelPoint);
     const int step = mLineStyle==lsImpulse ? 2 : 1; // impulse plot differs from other line styles in that the lineData points are only pairwise connected
     for (int i=0; i<lineData.size()-1; i+=step)
@@ -21623,6 +22509,21 @@ double QCPGraph::pointDistance(const QPointF &pixelPoint, QCPGraphDataContainer:
   return qSqrt(minDistSqr);
 }
 
+/*! \internal
+  
+  Returns the range of data values that, after the value transformation (see \ref
+  setValueTransform), are drawn within \a radius pixels of the pixel coordinate \a valuePixel along
+  the value axis. Used by \ref pointDistance to narrow down the data points in question.
+*/
+QCPRange QCPGraph::valueWindow(double valuePixel, double radius) const
+{
+  if (mValueScale == 0) // all data points are drawn at the same value, so none can be ruled out
+    return QCPRange(-std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+  const double lower = mValueAxis->pixelToCoord(valuePixel-radius);
+  const double upper = mValueAxis->pixelToCoord(valuePixel+radius);
+  return QCPRange((lower-mValueOffset)/mValueScale, (upper-mValueOffset)/mValueScale); // QCPRange normalizes internally, so reversed axes and negative scales don't matter
+}
+
 /*! \internal
   
   Finds the highest index of \a data, whose points y value is just below \a y. Assumes y values in
@@ -21645,97 +22546,423 @@ int QCPGraph::findIndexBelowY(const QVector<QPointF> *data, double y) const
   }
   return -1;
 }
-/* end of 'src/plottables/plottable-graph.cpp' */
-
-
-/* including file 'src/plottables/plottable-curve.cpp', size 63527           */
-/* commit 9868e55d3b412f2f89766bb482fcf299e93a0988 2017-09-04 01:56:22 +0200 */
 
+#ifdef QCP_OPENGL_FBO
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// QCPCurveData
+//////////////////// QCPGlLineRenderer
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-/*! \class QCPCurveData
-  \brief Holds the data of one single data point for QCPCurve.
-  
-  The stored data is:
-  \li \a t: the free ordering parameter of this curve point, like in the mathematical vector <em>(x(t), y(t))</em>. (This is the \a sortKey)
-  \li \a key: coordinate on the key axis of this curve point (this is the \a mainKey)
-  \li \a value: coordinate on the value axis of this curve point (this is the \a mainValue)
-  
-  The container for storing multiple data points is \ref QCPCurveDataContainer. It is a typedef for
-  \ref QCPDataContainer with \ref QCPCurveData as the DataType template parameter. See the
-  documentation there for an explanation regarding the data type's generic methods.
-  
-  \see QCPCurveDataContainer
-*/
+/*! \class QCPGlLineRenderer
+  \brief Draws graph lines from vertex buffers kept on the GPU
 
-/* start documentation of inline functions */
+  With OpenGL enabled (\ref QCustomPlot::setOpenGl), QCustomPlot paints into frame buffer objects,
+  but the lines are still built by QPainter: every replot transforms each visible data point to a
+  pixel on the CPU, and the OpenGL paint engine tessellates the resulting polyline. If the plotting
+  hint \ref QCP::phGlLines is set, \ref QCPGraph::draw hands its line to this renderer instead.
 
-/*! \fn double QCPCurveData::sortKey() const
-  
-  Returns the \a t member of this data point.
-  
-  For a general explanation of what this method is good for in the context of the data container,
-  see the documentation of \ref QCPDataContainer.
-*/
+  The renderer mirrors the data of each graph in a vertex buffer. Using \ref
+  QCPDataContainer::revision and \ref QCPDataContainer::storageOffset, only the data points
+  appended since the previous replot are uploaded, and data discarded at the front (e.g. by \ref
+  QCPDataContainer::setCapacity) costs nothing. The coordinate to pixel transformation is done by
+  the vertex shader, so a replot after a range change uploads nothing at all. Keys are stored as
+  the sum of two floats, which keeps their precision close to that of a double even for large keys
+  like time stamps.
 
-/*! \fn static QCPCurveData QCPCurveData::fromSortKey(double sortKey)
-  
-  Returns a data point with the specified \a sortKey (assigned to the data point's \a t member).
-  All other members are set to zero.
-  
-  For a general explanation of what this method is good for in the context of the data container,
-  see the documentation of \ref QCPDataContainer.
-*/
+  Only graphs that this produces exactly are handled: \ref QCPGraph::lsLine without scatters, fill
+  or selection, a solid pen no wider than the OpenGL implementation supports, linear axes and no NaN
+  values from the first visible data point on. \ref drawGraph returns false for all other graphs, which are then drawn with
+  QPainter as usual. The shaders only need OpenGL 2.0 or OpenGL ES 2.0, so software
+  implementations like Mesa's llvmpipe work too.
 
-/*! \fn static static bool QCPCurveData::sortKeyIsMainKey()
-  
-  Since the member \a key is the data point key coordinate and the member \a t is the data ordering
-  parameter, this method returns false.
-  
-  For a general explanation of what this method is good for in the context of the data container,
-  see the documentation of \ref QCPDataContainer.
+  An instance is created by \ref QCustomPlot::setupOpenGl for the plot's context and deleted by
+  \ref QCustomPlot::freeOpenGl. There is usually no need to use this class directly.
 */
 
-/*! \fn double QCPCurveData::mainKey() const
-  
-  Returns the \a key member of this data point.
-  
-  For a general explanation of what this method is good for in the context of the data container,
-  see the documentation of \ref QCPDataContainer.
-*/
+/* start of documentation of inline functions */
 
-/*! \fn double QCPCurveData::mainValue() const
-  
-  Returns the \a value member of this data point.
-  
-  For a general explanation of what this method is good for in the context of the data container,
-  see the documentation of \ref QCPDataContainer.
-*/
+/*! \fn bool QCPGlLineRenderer::isValid() const
 
-/*! \fn QCPRange QCPCurveData::valueRange() const
-  
-  Returns a QCPRange with both lower and upper boundary set to \a value of this data point.
-  
-  For a general explanation of what this method is good for in the context of the data container,
-  see the documentation of \ref QCPDataContainer.
+  Returns whether the shaders were built successfully. An invalid renderer doesn't draw anything.
 */
 
-/* end documentation of inline functions */
+/* end of documentation of inline functions */
 
 /*!
-  Constructs a curve data point with t, key and value set to zero.
+  Creates a renderer for the OpenGL \a context and builds its shaders. The context must stay alive
+  as long as the renderer.
 */
-QCPCurveData::QCPCurveData() :
-  t(0),
-  key(0),
-  value(0)
+QCPGlLineRenderer::QCPGlLineRenderer(QOpenGLContext *context) :
+  mContext(context),
+  mMaxLineWidth(1),
+  mValid(false)
 {
+  makeCurrent();
+  initializeOpenGLFunctions();
+  
+  // the linear mapping of QCPAxisPixelTransform for both axes, followed by the painter's device transform:
+  const char *vertexShader =
+      "attribute highp float keyHigh;\n"
+      "attribute highp float keyLow;\n"
+      "attribute highp float value;\n"
+      "uniform highp vec4 keyMap;\n" // origin split like the keys, pixels per key, pixel of the origin
+      "uniform highp vec3 valueMap;\n" // origin, pixels per value, pixel of the origin
+      "uniform highp float verticalKey;\n" // 1 if the key axis is vertical, 0 otherwise
+      "uniform highp vec4 pixelToNdc;\n" // scale and offset from logical pixels to normalized device coordinates
+      "void main()\n"
+      "{\n"
+      "  highp float keyPixel = ((keyHigh-keyMap.x)+(keyLow-keyMap.y))*keyMap.z+keyMap.w;\n"
+      "  highp float valuePixel = (value-valueMap.x)*valueMap.y+valueMap.z;\n"
+      "  highp vec2 pixel = mix(vec2(keyPixel, valuePixel), vec2(valuePixel, keyPixel), verticalKey);\n"
+      "  gl_Position = vec4(pixel*pixelToNdc.xy+pixelToNdc.zw, 0.0, 1.0);\n"
+      "}\n";
+  const char *fragmentShader =
+      "uniform lowp vec4 color;\n" // premultiplied, like the colors of the OpenGL paint engine
+      "void main()\n"
+      "{\n"
+      "  gl_FragColor = color;\n"
+      "}\n";
+  
+  mValid = mProgram.addShaderFromSourceCode(QOpenGLShader::Vertex, vertexShader) &&
+           mProgram.addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentShader);
+  if (mValid)
+  {
+    mProgram.bindAttributeLocation("keyHigh", KeyHighAttribute);
+    mProgram.bindAttributeLocation("keyLow", KeyLowAttribute);
+    mProgram.bindAttributeLocation("value", ValueAttribute);
+    mValid = mProgram.link();
+  }
+  if (!mValid)
+    qDebug() << Q_FUNC_INFO << "Failed to build the line shaders:" << mProgram.log();
+  
+  GLfloat lineWidthRange[2] = {1, 1};
+  glGetFloatv(GL_ALIASED_LINE_WIDTH_RANGE, lineWidthRange);
+  mMaxLineWidth = lineWidthRange[1];
 }
 
-/*!
-  Constructs a curve data point with the specified \a t, \a key and \a value.
+QCPGlLineRenderer::~QCPGlLineRenderer()
+{
+  makeCurrent(); // the buffers and the program free their OpenGL objects in the context
+  qDeleteAll(mBuffers);
+  mBuffers.clear();
+}
+
+/*!
+  Draws the line of \a graph with \a painter, which must be painting into an OpenGL paint buffer of
+  this renderer's context. Before drawing, the graph's vertex buffer is brought up to date with its
+  data.
+
+  Returns false without drawing anything if the graph can't be drawn by this renderer (see the
+  class description). The caller should then draw the graph with QPainter.
+*/
+bool QCPGlLineRenderer::drawGraph(QCPPainter *painter, const QCPGraph *graph)
+{
+  double lineWidth = 1;
+  if (!mValid || !canDraw(painter, graph, &lineWidth))
+    return false;
+  
+  QCPAxis *keyAxis = graph->keyAxis();
+  QCPAxis *valueAxis = graph->valueAxis();
+  const QTransform transform = painter->deviceTransform();
+  const QRectF clip = painter->hasClipping() ? painter->clipBoundingRect() : QRectF(keyAxis->axisRect()->rect());
+  
+  // the visible data points, plus the ones just outside so the line reaches the axis rect border:
+  const QSharedPointer<QCPGraphDataContainer> data = graph->data();
+  const QCPGraphDataContainer::const_iterator begin = data->findBegin(keyAxis->range().lower);
+  const QCPGraphDataContainer::const_iterator end = data->findEnd(keyAxis->range().upper);
+  const int first = data->storageOffset()+int(begin-data->constBegin());
+  const int count = int(end-begin);
+  
+  painter->beginNativePainting();
+  GraphBuffer *buffer = syncBuffer(graph);
+  const bool drawable = buffer && buffer->lastNaN < first; // gaps at NaN values are left to QPainter, NaNs scrolled out of view don't matter
+  if (drawable)
+  {
+    GLint viewport[4] = {0, 0, 1, 1};
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    const double width = qMax(1, viewport[2]);
+    const double height = qMax(1, viewport[3]);
+    
+    // fold the graph's value transform into the mapping of the value axis:
+    const QCPAxisPixelTransform keyMap(keyAxis);
+    const QCPAxisPixelTransform valueMap(valueAxis);
+    const double valueScale = graph->valueScale();
+    const double valueOffset = graph->valueOffset();
+    double valueOrigin = 0;
+    double pixelsPerValue = 0;
+    double valueOriginPixel = valueMap.map(valueOffset);
+    if (valueScale != 0)
+    {
+      valueOrigin = (valueMap.origin-valueOffset)/valueScale;
+      pixelsPerValue = valueMap.scale*valueScale;
+      valueOriginPixel = valueMap.offset;
+    }
+    const GLfloat keyOriginHigh = GLfloat(keyMap.origin);
+    const QColor color = graph->pen().color();
+    
+    mProgram.bind();
+    mProgram.setUniformValue("keyMap", keyOriginHigh, GLfloat(keyMap.origin-double(keyOriginHigh)), GLfloat(keyMap.scale), GLfloat(keyMap.offset));
+    mProgram.setUniformValue("valueMap", GLfloat(valueOrigin), GLfloat(pixelsPerValue), GLfloat(valueOriginPixel));
+    mProgram.setUniformValue("verticalKey", GLfloat(keyAxis->orientation() == Qt::Vertical ? 1 : 0));
+    // logical pixels to device pixels (origin top left) to normalized device coordinates (origin center, y up):
+    mProgram.setUniformValue("pixelToNdc", GLfloat(2*transform.m11()/width), GLfloat(-2*transform.m22()/height),
+                             GLfloat(2*transform.dx()/width-1), GLfloat(1-2*transform.dy()/height));
+    mProgram.setUniformValue("color", GLfloat(color.redF()*color.alphaF()), GLfloat(color.greenF()*color.alphaF()),
+                             GLfloat(color.blueF()*color.alphaF()), GLfloat(color.alphaF()));
+    
+    const QRect deviceClip = transform.mapRect(clip).toAlignedRect() & QRect(0, 0, int(width), int(height));
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(deviceClip.left(), int(height)-deviceClip.bottom()-1, deviceClip.width(), deviceClip.height());
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_STENCIL_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glLineWidth(GLfloat(lineWidth));
+    
+    const int stride = VertexComponents*int(sizeof(GLfloat));
+    buffer->vertices.bind();
+    mProgram.enableAttributeArray(KeyHighAttribute);
+    mProgram.enableAttributeArray(KeyLowAttribute);
+    mProgram.enableAttributeArray(ValueAttribute);
+    mProgram.setAttributeBuffer(KeyHighAttribute, GL_FLOAT, 0, 1, stride);
+    mProgram.setAttributeBuffer(KeyLowAttribute, GL_FLOAT, int(sizeof(GLfloat)), 1, stride);
+    mProgram.setAttributeBuffer(ValueAttribute, GL_FLOAT, 2*int(sizeof(GLfloat)), 1, stride);
+    if (count > 1)
+      glDrawArrays(GL_LINE_STRIP, first, count);
+    mProgram.disableAttributeArray(KeyHighAttribute);
+    mProgram.disableAttributeArray(KeyLowAttribute);
+    mProgram.disableAttributeArray(ValueAttribute);
+    buffer->vertices.release();
+    mProgram.release();
+    glLineWidth(1);
+    glDisable(GL_SCISSOR_TEST);
+  }
+  painter->endNativePainting(); // the paint engine restores its own state
+  return drawable;
+}
+
+/*!
+  Frees the vertex buffer of \a graph. This is called by the destructor of \ref QCPGraph.
+*/
+void QCPGlLineRenderer::releaseGraph(const QCPGraph *graph)
+{
+  if (GraphBuffer *buffer = mBuffers.take(graph))
+  {
+    makeCurrent();
+    delete buffer;
+  }
+}
+
+/*! \internal
+
+  Makes the renderer's context current, if it isn't already.
+*/
+void QCPGlLineRenderer::makeCurrent()
+{
+  if (QOpenGLContext::currentContext() != mContext)
+    mContext->makeCurrent(mContext->surface());
+}
+
+/*! \internal
+
+  Returns whether \a graph, painted with \a painter, looks the same when drawn by this renderer as
+  when drawn with QPainter. If so, \a lineWidth is set to the width of the pen in device pixels.
+*/
+bool QCPGlLineRenderer::canDraw(QCPPainter *painter, const QCPGraph *graph, double *lineWidth) const
+{
+  if (!painter->paintEngine() || painter->paintEngine()->type() != QPaintEngine::OpenGL2)
+    return false; // e.g. exports, which paint into pixmaps, pdfs or printers
+  if (graph->lineStyle() != QCPGraph::lsLine || !graph->scatterStyle().isNone() || graph->brush().style() != Qt::NoBrush || graph->selected())
+    return false;
+  const QPen pen = graph->pen();
+  if (pen.style() != Qt::SolidLine || pen.brush().style() != Qt::SolidPattern)
+    return false;
+  const QCPAxis *keyAxis = graph->keyAxis();
+  const QCPAxis *valueAxis = graph->valueAxis();
+  if (keyAxis->scaleType() != QCPAxis::stLinear || valueAxis->scaleType() != QCPAxis::stLinear || keyAxis->orientation() == valueAxis->orientation())
+    return false;
+  const QTransform transform = painter->deviceTransform();
+  if (transform.type() > QTransform::TxScale)
+    return false;
+  // cosmetic pens have the same width on every device, others scale with the painter:
+  *lineWidth = qMax(1.0, pen.widthF())*(pen.isCosmetic() ? 1.0 : qAbs(transform.m11()));
+  return *lineWidth <= mMaxLineWidth;
+}
+
+/*! \internal
+
+  Returns the vertex buffer of \a graph, creating it if necessary, after uploading the data points
+  that aren't in it yet. If the graph's data container was replaced or its \ref
+  QCPDataContainer::revision changed, all data points are uploaded again. Returns 0 if no buffer
+  could be created.
+
+  The vertex buffer is indexed by the storage position of the data points (see \ref
+  QCPDataContainer::storageOffset), so it stays valid when data is discarded at the front.
+*/
+QCPGlLineRenderer::GraphBuffer *QCPGlLineRenderer::syncBuffer(const QCPGraph *graph)
+{
+  const QSharedPointer<QCPGraphDataContainer> data = graph->data();
+  GraphBuffer *buffer = mBuffers.value(graph);
+  if (!buffer)
+  {
+    buffer = new GraphBuffer;
+    buffer->revision = 0;
+    buffer->uploaded = 0;
+    buffer->capacity = 0;
+    buffer->lastNaN = -1;
+    buffer->vertices.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    if (!buffer->vertices.create())
+    {
+      qDebug() << Q_FUNC_INFO << "Failed to create vertex buffer";
+      delete buffer;
+      return 0;
+    }
+    mBuffers.insert(graph, buffer);
+  }
+  
+  const int storageEnd = data->storageOffset()+data->size();
+  if (buffer->data.toStrongRef() != data || buffer->revision != data->revision() || storageEnd < buffer->uploaded)
+  {
+    buffer->data = data;
+    buffer->revision = data->revision();
+    buffer->uploaded = 0;
+    buffer->lastNaN = -1;
+  }
+  
+  buffer->vertices.bind();
+  if (storageEnd > buffer->capacity)
+  {
+    buffer->capacity = qMax(int(UploadBlockSize), storageEnd+storageEnd/2); // leave room for appending, like QVector
+    buffer->vertices.allocate(buffer->capacity*VertexComponents*int(sizeof(GLfloat)));
+    buffer->uploaded = 0; // allocate discards the previous content
+    buffer->lastNaN = -1; // found again by the upload
+  }
+  if (buffer->uploaded < storageEnd)
+    upload(buffer, *data, qMax(buffer->uploaded, data->storageOffset()), storageEnd);
+  buffer->uploaded = storageEnd;
+  buffer->vertices.release();
+  return buffer;
+}
+
+/*! \internal
+
+  Writes the data points at the storage positions \a from up to (but not including) \a to of \a data
+  into the bound vertex buffer of \a buffer. Keys are split into a float and the float of the
+  remainder. The conversion goes through a staging block of \c UploadBlockSize vertices, so the
+  first upload of a large graph doesn't need a second copy of all its data in memory.
+*/
+void QCPGlLineRenderer::upload(GraphBuffer *buffer, const QCPGraphDataContainer &data, int from, int to)
+{
+  QCPGraphDataContainer::const_iterator it = data.constBegin()+(from-data.storageOffset());
+  for (int blockBegin=from; blockBegin<to; blockBegin+=UploadBlockSize)
+  {
+    const int blockEnd = qMin(blockBegin+int(UploadBlockSize), to);
+    mStaging.resize((blockEnd-blockBegin)*VertexComponents);
+    GLfloat *vertex = mStaging.data();
+    for (int i=blockBegin; i<blockEnd; ++i, ++it)
+    {
+      const GLfloat keyHigh = GLfloat(it->key);
+      vertex[0] = keyHigh;
+      vertex[1] = GLfloat(it->key-double(keyHigh));
+      vertex[2] = GLfloat(it->value);
+      if (qIsNaN(it->value))
+        buffer->lastNaN = i;
+      vertex += VertexComponents;
+    }
+    buffer->vertices.write(blockBegin*VertexComponents*int(sizeof(GLfloat)), mStaging.constData(), mStaging.size()*int(sizeof(GLfloat)));
+  }
+}
+#endif // QCP_OPENGL_FBO
+/* end of 'src/plottables/plottable-graph.cpp' */
+
+
+/* including file 'src/plottables/plottable-curve.cpp', size 63527           */
+/* commit 9868e55d3b412f2f89766bb482fcf299e93a0988 2017-09-04 01:56:22 +0200 */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPCurveData
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPCurveData
+  \brief Holds the data of one single data point for QCPCurve.
+  
+  The stored data is:
+  \li \a t: the free ordering parameter of this curve point, like in the mathematical vector <em>(x(t), y(t))</em>. (This is the \a sortKey)
+  \li \a key: coordinate on the key axis of this curve point (this is the \a mainKey)
+  \li \a value: coordinate on the value axis of this curve point (this is the \a mainValue)
+  
+  The container for storing multiple data points is \ref QCPCurveDataContainer. It is a typedef for
+  \ref QCPDataContainer with \ref QCPCurveData as the DataType template parameter. See the
+  documentation there for an explanation regarding the data type's generic methods.
+  
+  \see QCPCurveDataContainer
+*/
+
+/* start documentation of inline functions */
+
+/*! \fn double QCPCurveData::sortKey() const
+  
+  Returns the \a t member of this data point.
+  
+  For a general explanation of what this method is good for in the context of the data container,
+  see the documentation of \ref QCPDataContainer.
+*/
+
+/*! \fn static QCPCurveData QCPCurveData::fromSortKey(double sortKey)
+  
+  Returns a data point with the specified \a sortKey (assigned to the data point's \a t member).
+  All other members are set to zero.
+  
+  For a general explanation of what this method is good for in the context of the data container,
+  see the documentation of \ref QCPDataContainer.
+*/
+
+/*! \fn static static bool QCPCurveData::sortKeyIsMainKey()
+  
+  Since the member \a key is the data point key coordinate and the member \a t is the data ordering
+  parameter, this method returns false.
+  
+  For a general explanation of what this method is good for in the context of the data container,
+  see the documentation of \ref QCPDataContainer.
+*/
+
+/*! \fn double QCPCurveData::mainKey() const
+  
+  Returns the \a key member of this data point.
+  
+  For a general explanation of what this method is good for in the context of the data container,
+  see the documentation of \ref QCPDataContainer.
+*/
+
+/*! \fn double QCPCurveData::mainValue() const
+  
+  Returns the \a value member of this data point.
+  
+  For a general explanation of what this method is good for in the context of the data container,
+  see the documentation of \ref QCPDataContainer.
+*/
+
+/*! \fn QCPRange QCPCurveData::valueRange() const
+  
+  Returns a QCPRange with both lower and upper boundary set to \a value of this data point.
+  
+  For a general explanation of what this method is good for in the context of the data container,
+  see the documentation of \ref QCPDataContainer.
+*/
+
+/* end documentation of inline functions */
+
+/*!
+  Constructs a curve data point with t, key and value set to zero.
+*/
+QCPCurveData::QCPCurveData() :
+  t(0),
+  key(0),
+  value(0)
+{
+}
+
+/*!
+  Constructs a curve data point with the specified \a t, \a key and \a value.
 */
 QCPCurveData::QCPCurveData(double t, double key, double value) :
   t(t),
@@ -25219,7 +26446,7 @@ void QCPColorMapData::setData(double key, double value, double z)
       mDataBounds.lower = z;
     if (z > mDataBounds.upper)
       mDataBounds.upper = z;
-     mDataModified = true;
+    mModifiedCells |= QRect(keyCell, valueCell, 1, 1);
   }
 }
 
@@ -25243,7 +26470,7 @@ void QCPColorMapData::setCell(int keyIndex, int valueIndex, double z)
       mDataBounds.lower = z;
     if (z > mDataBounds.upper)
       mDataBounds.upper = z;
-     mDataModified = true;
+    mModifiedCells |= QRect(keyIndex, valueIndex, 1, 1);
   } else
     qDebug() << Q_FUNC_INFO << "index out of bounds:" << keyIndex << valueIndex;
 }
@@ -25270,7 +26497,7 @@ void QCPColorMapData::setAlpha(int keyIndex, int valueIndex, unsigned char alpha
     if (mAlpha || createAlpha())
     {
       mAlpha[valueIndex*mKeySize + keyIndex] = alpha;
-      mDataModified = true;
+      mModifiedCells |= QRect(keyIndex, valueIndex, 1, 1);
     }
   } else
     qDebug() << Q_FUNC_INFO << "index out of bounds:" << keyIndex << valueIndex;
@@ -25477,6 +26704,12 @@ bool QCPColorMapData::createAlpha(bool initializeOpaque)
   setCell, since it doesn't need to do any coordinate transformation and thus performs a bit
   better.
   
+  Changes made with \ref QCPColorMapData::setCell, \ref QCPColorMapData::setData and \ref
+  QCPColorMapData::setAlpha are tracked, so the next replot only recolors the cells inside their
+  bounding rectangle. A streaming spectrogram that writes one column per frame therefore only
+  recolors that column. Large map images are colorized on several threads if QCustomPlot is
+  compiled with \c QCUSTOMPLOT_USE_CONCURRENT defined (which requires the Qt Concurrent module).
+  
   The cell with index (0, 0) is at the bottom left, if the color map uses normal (i.e. not reversed)
   key and value axes.
   
@@ -25879,12 +27112,16 @@ QCPRange QCPColorMap::getValueRange(bool &foundRange, QCP::SignDomain inSignDoma
   
   This method is called by \ref QCPColorMap::draw if either the data has been modified or the map image
   has been invalidated for a different reason (e.g. a change of the data range with \ref
-  setDataRange).
+  setDataRange). If only single cells were changed since the last update (see \ref
+  QCPColorMapData::setCell), only the rectangle of cells enclosing them is recolored.
   
   If the map cell count is low, the image created will be oversampled in order to avoid a
   QPainter::drawImage bug which makes inner pixel boundaries jitter when stretch-drawing images
   without smooth transform enabled. Accordingly, oversampling isn't performed if \ref
   setInterpolate is true.
+  
+  If \c QCP_CONCURRENT is defined, the image lines of large updates are split into blocks that are
+  colorized in parallel on the global thread pool, see \ref colorizeLines.
 */
 void QCPColorMap::updateMapImage()
 {
@@ -25897,12 +27134,18 @@ void QCPColorMap::updateMapImage()
   const int valueSize = mMapData->valueSize();
   int keyOversamplingFactor = mInterpolate ? 1 : (int)(1.0+100.0/(double)keySize); // make mMapImage have at least size 100, factor becomes 1 if size > 200 or interpolation is on
   int valueOversamplingFactor = mInterpolate ? 1 : (int)(1.0+100.0/(double)valueSize); // make mMapImage have at least size 100, factor becomes 1 if size > 200 or interpolation is on
+  bool fullUpdate = mMapData->mDataModified || mMapImageInvalidated; // otherwise only mMapData->mModifiedCells need to be recolored
   
   // resize mMapImage to correct dimensions including possible oversampling factors, according to key/value axes orientation:
   if (keyAxis->orientation() == Qt::Horizontal && (mMapImage.width() != keySize*keyOversamplingFactor || mMapImage.height() != valueSize*valueOversamplingFactor))
+  {
     mMapImage = QImage(QSize(keySize*keyOversamplingFactor, valueSize*valueOversamplingFactor), format);
-  else if (keyAxis->orientation() == Qt::Vertical && (mMapImage.width() != valueSize*valueOversamplingFactor || mMapImage.height() != keySize*keyOversamplingFactor))
+    fullUpdate = true;
+  } else if (keyAxis->orientation() == Qt::Vertical && (mMapImage.width() != valueSize*valueOversamplingFactor || mMapImage.height() != keySize*keyOversamplingFactor))
+  {
     mMapImage = QImage(QSize(valueSize*valueOversamplingFactor, keySize*keyOversamplingFactor), format);
+    fullUpdate = true;
+  }
   
   if (mMapImage.isNull())
   {
@@ -25916,39 +27159,71 @@ void QCPColorMap::updateMapImage()
     {
       // resize undersampled map image to actual key/value cell sizes:
       if (keyAxis->orientation() == Qt::Horizontal && (mUndersampledMapImage.width() != keySize || mUndersampledMapImage.height() != valueSize))
+      {
         mUndersampledMapImage = QImage(QSize(keySize, valueSize), format);
-      else if (keyAxis->orientation() == Qt::Vertical && (mUndersampledMapImage.width() != valueSize || mUndersampledMapImage.height() != keySize))
+        fullUpdate = true;
+      } else if (keyAxis->orientation() == Qt::Vertical && (mUndersampledMapImage.width() != valueSize || mUndersampledMapImage.height() != keySize))
+      {
         mUndersampledMapImage = QImage(QSize(valueSize, keySize), format);
+        fullUpdate = true;
+      }
       localMapImage = &mUndersampledMapImage; // make the colorization run on the undersampled image
     } else if (!mUndersampledMapImage.isNull())
       mUndersampledMapImage = QImage(); // don't need oversampling mechanism anymore (map size has changed) but mUndersampledMapImage still has nonzero size, free it
     
-    const double *rawData = mMapData->mData;
-    const unsigned char *rawAlpha = mMapData->mAlpha;
+    // determine the cells to colorize, as image lines (value cells for a horizontal key axis, key cells otherwise) and
+    // columns within those lines:
+    QRect cells = QRect(0, 0, keySize, valueSize);
+    if (!fullUpdate)
+      cells &= mMapData->mModifiedCells;
+    ColorizeTask task;
+    task.gradient = &mGradient;
+    task.data = mMapData->mData;
+    task.alpha = mMapData->mAlpha;
+    task.range = mDataRange;
+    task.logarithmic = mDataScaleType == QCPAxis::stLogarithmic;
+    task.bits = localMapImage->bits(); // detaches here, so the tasks below can write to the image concurrently
+    task.bytesPerLine = localMapImage->bytesPerLine();
     if (keyAxis->orientation() == Qt::Horizontal)
     {
-      const int lineCount = valueSize;
-      const int rowCount = keySize;
-      for (int line=0; line<lineCount; ++line)
-      {
-        QRgb* pixels = reinterpret_cast<QRgb*>(localMapImage->scanLine(lineCount-1-line)); // invert scanline index because QImage counts scanlines from top, but our vertical index counts from bottom (mathematical coordinate system)
-        if (rawAlpha)
-          mGradient.colorize(rawData+line*rowCount, rawAlpha+line*rowCount, mDataRange, pixels, rowCount, 1, mDataScaleType==QCPAxis::stLogarithmic);
-        else
-          mGradient.colorize(rawData+line*rowCount, mDataRange, pixels, rowCount, 1, mDataScaleType==QCPAxis::stLogarithmic);
-      }
+      task.lineStride = keySize;
+      task.columnStride = 1;
+      task.lineCount = valueSize;
+      task.lineFrom = cells.top();
+      task.lineTo = cells.bottom()+1;
+      task.columnFrom = cells.left();
+      task.columnTo = cells.right()+1;
     } else // keyAxis->orientation() == Qt::Vertical
     {
-      const int lineCount = keySize;
-      const int rowCount = valueSize;
-      for (int line=0; line<lineCount; ++line)
+      task.lineStride = 1;
+      task.columnStride = keySize;
+      task.lineCount = keySize;
+      task.lineFrom = cells.left();
+      task.lineTo = cells.right()+1;
+      task.columnFrom = cells.top();
+      task.columnTo = cells.bottom()+1;
+    }
+    
+    if (!cells.isEmpty())
+    {
+      if (mGradient.mColorBufferInvalidated) // colorize would update the color buffer on first use, do it before the tasks share the gradient
+        mGradient.updateColorBuffer();
+#ifdef QCP_CONCURRENT
+      const int blockCount = qMin(task.lineTo-task.lineFrom, 4*QThread::idealThreadCount());
+      if (cells.width()*cells.height() >= ParallelColorizeCells && blockCount > 1)
       {
-        QRgb* pixels = reinterpret_cast<QRgb*>(localMapImage->scanLine(lineCount-1-line)); // invert scanline index because QImage counts scanlines from top, but our vertical index counts from bottom (mathematical coordinate system)
-        if (rawAlpha)
-          mGradient.colorize(rawData+line, rawAlpha+line, mDataRange, pixels, rowCount, lineCount, mDataScaleType==QCPAxis::stLogarithmic);
-        else
-          mGradient.colorize(rawData+line, mDataRange, pixels, rowCount, lineCount, mDataScaleType==QCPAxis::stLogarithmic);
-      }
+        QVector<ColorizeTask> blocks(blockCount, task);
+        for (int i=0; i<blockCount; ++i)
+        {
+          blocks[i].lineFrom = task.lineFrom+(task.lineTo-task.lineFrom)*i/blockCount;
+          blocks[i].lineTo = task.lineFrom+(task.lineTo-task.lineFrom)*(i+1)/blockCount;
+        }
+        QtConcurrent::blockingMap(blocks, colorizeLines);
+      } else
+        colorizeLines(task);
+#else
+      colorizeLines(task);
+#endif
     }
     
     if (keyOversamplingFactor > 1 || valueOversamplingFactor > 1)
@@ -25960,9 +27235,35 @@ void QCPColorMap::updateMapImage()
     }
   }
   mMapData->mDataModified = false;
+  mMapData->mModifiedCells = QRect();
   mMapImageInvalidated = false;
 }
 
+/*! \internal
+  
+  Colorizes the lines \a task.lineFrom up to (but not including) \a task.lineTo of the map image
+  described by \a task, each from column \a task.columnFrom up to (but not including) \a
+  task.columnTo, with \ref QCPColorGradient::colorize. Lines are counted from the bottom of the
+  image (mathematical coordinate system), and the data of line \a l and column \a c is found at
+  index <tt>l*lineStride+c*columnStride</tt>.
+  
+  Tasks covering different lines may run concurrently, as long as the color buffer of the gradient
+  is up to date (see \ref updateMapImage).
+*/
+void QCPColorMap::colorizeLines(const ColorizeTask &task)
+{
+  const int n = task.columnTo-task.columnFrom;
+  for (int line=task.lineFrom; line<task.lineTo; ++line)
+  {
+    QRgb* pixels = reinterpret_cast<QRgb*>(task.bits+(task.lineCount-1-line)*task.bytesPerLine)+task.columnFrom; // invert scanline index because QImage counts scanlines from top, but our vertical index counts from bottom (mathematical coordinate system)
+    const int offset = line*task.lineStride+task.columnFrom*task.columnStride;
+    if (task.alpha)
+      task.gradient->colorize(task.data+offset, task.alpha+offset, task.range, pixels, n, task.columnStride, task.logarithmic);
+    else
+      task.gradient->colorize(task.data+offset, task.range, pixels, n, task.columnStride, task.logarithmic);
+  }
+}
+
 /* inherits documentation from base class */
 void QCPColorMap::draw(QCPPainter *painter)
 {
@@ -25970,7 +27271,7 @@ void QCPColorMap::draw(QCPPainter *painter)
   if (!mKeyAxis || !mValueAxis) return;
   applyDefaultAntialiasingHint(painter);
   
-  if (mMapData->mDataModified || mMapImageInvalidated)
+  if (mMapData->mDataModified || mMapImageInvalidated || !mMapData->mModifiedCells.isEmpty())
     updateMapImage();
   
   // use buffer if painting vectorized (PDF):
@@ -26051,6 +27352,475 @@ void QCPColorMap::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
   painter->drawRect(rect.adjusted(1, 1, 0, 0));
   */
 }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPWaterfall
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPWaterfall
+  \brief A plottable representing a scrolling waterfall (spectrogram) of columns of data.
+
+  A waterfall shows a stream of columns, typically spectra, side by side along the key axis. Each
+  column has \ref rowCount cells, spread evenly over the \ref setValueRange along the value axis,
+  and is drawn with the colors of the \ref setGradient like a \ref QCPColorMap. New columns are
+  appended with \ref addColumn. Once \ref columnCount columns are held, each new column replaces
+  the oldest one.
+
+  Unlike a \ref QCPColorMap, which recolors its image when cells change, the waterfall keeps its
+  data and its colorized image in ring buffers with one slot per column. Appending a column costs
+  O(\ref rowCount): the values are copied into the slot of the oldest column, and on the next
+  replot only that slot is colorized. Scrolling happens while drawing: the two parts of the ring
+  are blitted to their places on the key axis, so the existing columns are never recolored or
+  moved. Only changes of the data range, data scale type or gradient recolor the whole image.
+
+  The key of each column marks its center. The columns are expected to arrive with ascending,
+  roughly equidistant keys. They are drawn with the average spacing of the held columns, so at
+  least two columns are needed for the waterfall to show up.
+
+  To show which colors correspond to which data values, a \ref QCPColorScale can be associated with
+  the waterfall via \ref setColorScale, just like with a \ref QCPColorMap.
+
+  \note Like QCPColorMap, the waterfall is drawn with a linear mapping, so logarithmic key or value
+  axes are not supported.
+*/
+
+/* start documentation of inline functions */
+
+/*! \fn int QCPWaterfall::size() const
+  
+  Returns the number of columns currently held, at most \ref columnCount.
+*/
+
+/*! \fn double QCPWaterfall::rowSpacing() const
+  
+  Returns the distance between the centers of two neighbouring rows in value coordinates.
+*/
+
+/* end documentation of inline functions */
+
+/* start documentation of signals */
+
+/*! \fn void QCPWaterfall::dataRangeChanged(const QCPRange &newRange);
+  
+  This signal is emitted when the data range changes.
+  
+  \see setDataRange
+*/
+
+/*! \fn void QCPWaterfall::dataScaleTypeChanged(QCPAxis::ScaleType scaleType);
+  
+  This signal is emitted when the data scale type changes.
+  
+  \see setDataScaleType
+*/
+
+/*! \fn void QCPWaterfall::gradientChanged(const QCPColorGradient &newGradient);
+  
+  This signal is emitted when the gradient changes.
+  
+  \see setGradient
+*/
+
+/* end documentation of signals */
+
+/*!
+  Constructs a waterfall with the specified \a keyAxis and \a valueAxis. It holds no columns until
+  a size is set with \ref setSize.
+  
+  The created QCPWaterfall is automatically registered with the QCustomPlot instance inferred from
+  \a keyAxis. This QCustomPlot instance takes ownership of the QCPWaterfall, so do not delete it
+  manually but use QCustomPlot::removePlottable() instead.
+*/
+QCPWaterfall::QCPWaterfall(QCPAxis *keyAxis, QCPAxis *valueAxis) :
+  QCPAbstractPlottable(keyAxis, valueAxis),
+  mValueRange(0, 1),
+  mDataScaleType(QCPAxis::stLinear),
+  mGradient(QCPColorGradient::gpCold),
+  mInterpolate(false),
+  mColumnCount(0),
+  mRowCount(0),
+  mFirstColumn(0),
+  mSize(0),
+  mUncolorizedColumns(0),
+  mImageInvalidated(true)
+{
+}
+
+/*!
+  Sets the waterfall to hold at most \a columnCount columns of \a rowCount cells each. If the size
+  changes, all columns are discarded.
+  
+  \see addColumn
+*/
+void QCPWaterfall::setSize(int columnCount, int rowCount)
+{
+  columnCount = qMax(0, columnCount);
+  rowCount = qMax(0, rowCount);
+  if (columnCount != mColumnCount || rowCount != mRowCount)
+  {
+    mColumnCount = columnCount;
+    mRowCount = rowCount;
+    mData.resize(mColumnCount*mRowCount);
+    mKeys.resize(mColumnCount);
+    clear();
+  }
+}
+
+/*!
+  Sets the value coordinates of the rows. The first row is centered on the lower bound of \a
+  valueRange and the last row on its upper bound, like the cells of a \ref QCPColorMapData.
+*/
+void QCPWaterfall::setValueRange(const QCPRange &valueRange)
+{
+  mValueRange = valueRange;
+}
+
+/*!
+  Sets the data range of this waterfall to \a dataRange. The data range defines which data values
+  are mapped to the color gradient. Changing it recolors all columns on the next replot.
+  
+  \see rescaleDataRange, QCPColorScale::setDataRange
+*/
+void QCPWaterfall::setDataRange(const QCPRange &dataRange)
+{
+  if (!QCPRange::validRange(dataRange)) return;
+  if (mDataRange.lower != dataRange.lower || mDataRange.upper != dataRange.upper)
+  {
+    if (mDataScaleType == QCPAxis::stLogarithmic)
+      mDataRange = dataRange.sanitizedForLogScale();
+    else
+      mDataRange = dataRange.sanitizedForLinScale();
+    mImageInvalidated = true;
+    emit dataRangeChanged(mDataRange);
+  }
+}
+
+/*!
+  Sets whether the data is correlated with the color gradient linearly or logarithmically.
+  
+  \see QCPColorScale::setDataScaleType
+*/
+void QCPWaterfall::setDataScaleType(QCPAxis::ScaleType scaleType)
+{
+  if (mDataScaleType != scaleType)
+  {
+    mDataScaleType = scaleType;
+    mImageInvalidated = true;
+    emit dataScaleTypeChanged(mDataScaleType);
+    if (mDataScaleType == QCPAxis::stLogarithmic)
+      setDataRange(mDataRange.sanitizedForLogScale());
+  }
+}
+
+/*!
+  Sets the color gradient that is used to represent the data, see \ref QCPColorMap::setGradient.
+  
+  \see QCPColorScale::setGradient
+*/
+void QCPWaterfall::setGradient(const QCPColorGradient &gradient)
+{
+  if (mGradient != gradient)
+  {
+    mGradient = gradient;
+    mImageInvalidated = true;
+    emit gradientChanged(mGradient);
+  }
+}
+
+/*!
+  Sets whether the image is smoothly interpolated when it is displayed at a scale other than one
+  pixel per cell. Note that the two parts of the ring buffer are interpolated separately, see the
+  class description.
+*/
+void QCPWaterfall::setInterpolate(bool enabled)
+{
+  mInterpolate = enabled;
+}
+
+/*!
+  Associates the color scale \a colorScale with this waterfall, so both synchronize their gradient,
+  data range and data scale type. See \ref QCPColorMap::setColorScale for details.
+  
+  Pass 0 as \a colorScale to disconnect the color scale from this waterfall again.
+*/
+void QCPWaterfall::setColorScale(QCPColorScale *colorScale)
+{
+  if (mColorScale) // unconnect signals from old color scale
+  {
+    disconnect(this, SIGNAL(dataRangeChanged(QCPRange)), mColorScale.data(), SLOT(setDataRange(QCPRange)));
+    disconnect(this, SIGNAL(dataScaleTypeChanged(QCPAxis::ScaleType)), mColorScale.data(), SLOT(setDataScaleType(QCPAxis::ScaleType)));
+    disconnect(this, SIGNAL(gradientChanged(QCPColorGradient)), mColorScale.data(), SLOT(setGradient(QCPColorGradient)));
+    disconnect(mColorScale.data(), SIGNAL(dataRangeChanged(QCPRange)), this, SLOT(setDataRange(QCPRange)));
+    disconnect(mColorScale.data(), SIGNAL(gradientChanged(QCPColorGradient)), this, SLOT(setGradient(QCPColorGradient)));
+    disconnect(mColorScale.data(), SIGNAL(dataScaleTypeChanged(QCPAxis::ScaleType)), this, SLOT(setDataScaleType(QCPAxis::ScaleType)));
+  }
+  mColorScale = colorScale;
+  if (mColorScale) // connect signals to new color scale
+  {
+    setGradient(mColorScale.data()->gradient());
+    setDataRange(mColorScale.data()->dataRange());
+    setDataScaleType(mColorScale.data()->dataScaleType());
+    connect(this, SIGNAL(dataRangeChanged(QCPRange)), mColorScale.data(), SLOT(setDataRange(QCPRange)));
+    connect(this, SIGNAL(dataScaleTypeChanged(QCPAxis::ScaleType)), mColorScale.data(), SLOT(setDataScaleType(QCPAxis::ScaleType)));
+    connect(this, SIGNAL(gradientChanged(QCPColorGradient)), mColorScale.data(), SLOT(setGradient(QCPColorGradient)));
+    connect(mColorScale.data(), SIGNAL(dataRangeChanged(QCPRange)), this, SLOT(setDataRange(QCPRange)));
+    connect(mColorScale.data(), SIGNAL(gradientChanged(QCPColorGradient)), this, SLOT(setGradient(QCPColorGradient)));
+    connect(mColorScale.data(), SIGNAL(dataScaleTypeChanged(QCPAxis::ScaleType)), this, SLOT(setDataScaleType(QCPAxis::ScaleType)));
+  }
+}
+
+/*!
+  Appends a column at \a key with the cell values \a values, the first of which belongs to the
+  lowest row. If the waterfall already holds \ref columnCount columns, the oldest one is replaced.
+  
+  \a values should have \ref rowCount entries. Surplus values are ignored and missing ones are set
+  to zero.
+  
+  This only copies \a values, the column is colorized on the next replot. Keys must be ascending,
+  see the class description.
+*/
+void QCPWaterfall::addColumn(double key, const QVector<double> &values)
+{
+  if (mColumnCount == 0 || mRowCount == 0)
+  {
+    qDebug() << Q_FUNC_INFO << "waterfall has no size, see setSize";
+    return;
+  }
+  if (values.size() != mRowCount)
+    qDebug() << Q_FUNC_INFO << "column has" << values.size() << "values instead of" << mRowCount;
+  
+  int slot;
+  if (mSize < mColumnCount)
+  {
+    slot = (mFirstColumn+mSize)%mColumnCount;
+    ++mSize;
+  } else // full, overwrite the oldest column
+  {
+    slot = mFirstColumn;
+    mFirstColumn = (mFirstColumn+1)%mColumnCount;
+  }
+  double *column = mData.data()+slot*mRowCount;
+  const int n = qMin(values.size(), mRowCount);
+  std::copy(values.constBegin(), values.constBegin()+n, column);
+  std::fill(column+n, column+mRowCount, 0.0);
+  mKeys[slot] = key;
+  if (mUncolorizedColumns < mColumnCount)
+    ++mUncolorizedColumns;
+}
+
+/*!
+  Discards all columns. The size set with \ref setSize is kept.
+*/
+void QCPWaterfall::clear()
+{
+  mFirstColumn = 0;
+  mSize = 0;
+  mUncolorizedColumns = 0;
+}
+
+/*!
+  Sets the data range (\ref setDataRange) to span the minimum and maximum values of the columns
+  currently held. NaN values are ignored. This goes through every cell, so it is meant to be
+  called occasionally, not after every new column.
+*/
+void QCPWaterfall::rescaleDataRange()
+{
+  double minValue = std::numeric_limits<double>::max();
+  double maxValue = -std::numeric_limits<double>::max();
+  for (int i=0; i<mSize; ++i)
+  {
+    const double *column = mData.constData()+((mFirstColumn+i)%mColumnCount)*mRowCount;
+    for (int row=0; row<mRowCount; ++row)
+    {
+      if (column[row] < minValue) // false for NaN
+        minValue = column[row];
+      if (column[row] > maxValue)
+        maxValue = column[row];
+    }
+  }
+  if (minValue <= maxValue)
+    setDataRange(QCPRange(minValue, maxValue));
+}
+
+/* inherits documentation from base class */
+double QCPWaterfall::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
+{
+  Q_UNUSED(details)
+  if ((onlySelectable && mSelectable == QCP::stNone) || mSize < 2)
+    return -1;
+  if (!mKeyAxis || !mValueAxis)
+    return -1;
+  
+  if (mKeyAxis.data()->axisRect()->rect().contains(pos.toPoint()))
+  {
+    bool foundKeyRange, foundValueRange;
+    const QCPRange keyRange = getKeyRange(foundKeyRange);
+    const QCPRange valueRange = getValueRange(foundValueRange);
+    double posKey, posValue;
+    pixelsToCoords(pos, posKey, posValue);
+    if (keyRange.contains(posKey) && valueRange.contains(posValue))
+    {
+      if (details)
+        details->setValue(QCPDataSelection(QCPDataRange(0, 1))); // whole-plottable selection, as with QCPColorMap
+      return mParentPlot->selectionTolerance()*0.99;
+    }
+  }
+  return -1;
+}
+
+/* inherits documentation from base class */
+QCPRange QCPWaterfall::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain) const
+{
+  foundRange = mSize > 0;
+  if (!foundRange)
+    return QCPRange();
+  
+  const double spacing = columnSpacing();
+  QCPRange result(mKeys.at(mFirstColumn)-spacing*0.5, mKeys.at((mFirstColumn+mSize-1)%mColumnCount)+spacing*0.5);
+  if (inSignDomain == QCP::sdPositive)
+  {
+    if (result.lower <= 0 && result.upper > 0)
+      result.lower = result.upper*1e-3;
+    else if (result.lower <= 0 && result.upper <= 0)
+      foundRange = false;
+  } else if (inSignDomain == QCP::sdNegative)
+  {
+    if (result.upper >= 0 && result.lower < 0)
+      result.upper = result.lower*1e-3;
+    else if (result.upper >= 0 && result.lower >= 0)
+      foundRange = false;
+  }
+  return result;
+}
+
+/* inherits documentation from base class */
+QCPRange QCPWaterfall::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain, const QCPRange &inKeyRange) const
+{
+  if (inKeyRange != QCPRange())
+  {
+    bool foundKeyRange;
+    const QCPRange keyRange = getKeyRange(foundKeyRange);
+    if (!foundKeyRange || keyRange.upper < inKeyRange.lower || keyRange.lower > inKeyRange.upper)
+    {
+      foundRange = false;
+      return QCPRange();
+    }
+  }
+  
+  foundRange = mRowCount > 0;
+  if (!foundRange)
+    return QCPRange();
+  QCPRange result(mValueRange.lower-rowSpacing()*0.5, mValueRange.upper+rowSpacing()*0.5);
+  if (inSignDomain == QCP::sdPositive)
+  {
+    if (result.lower <= 0 && result.upper > 0)
+      result.lower = result.upper*1e-3;
+    else if (result.lower <= 0 && result.upper <= 0)
+      foundRange = false;
+  } else if (inSignDomain == QCP::sdNegative)
+  {
+    if (result.upper >= 0 && result.lower < 0)
+      result.upper = result.lower*1e-3;
+    else if (result.upper >= 0 && result.lower >= 0)
+      foundRange = false;
+  }
+  return result;
+}
+
+/* inherits documentation from base class */
+void QCPWaterfall::draw(QCPPainter *painter)
+{
+  if (mSize < 2) return;
+  if (!mKeyAxis || !mValueAxis) return;
+  const double spacing = columnSpacing();
+  if (spacing <= 0) return;
+  
+  if (mImageInvalidated || mUncolorizedColumns > 0)
+    updateImage();
+  if (mImage.isNull()) return;
+  
+  // map the image (x: row, y: column in chronological order) onto the axes. Row r and column c are
+  // centered on the value of row r and the key of column c:
+  const double keyLower = mKeys.at(mFirstColumn)-spacing*0.5;
+  const double valueLower = mValueRange.lower-rowSpacing()*0.5;
+  const QPointF origin = coordsToPixels(keyLower, valueLower);
+  const QPointF rowStep = coordsToPixels(keyLower, valueLower+rowSpacing())-origin;
+  const QPointF columnStep = coordsToPixels(keyLower+spacing, valueLower)-origin;
+  
+  painter->save();
+  painter->setRenderHint(QPainter::SmoothPixmapTransform, mInterpolate);
+  painter->setTransform(QTransform(rowStep.x(), rowStep.y(), columnStep.x(), columnStep.y(), origin.x(), origin.y()), true);
+  // the oldest columns are at the end of the ring, the newest ones wrap around to its start:
+  const int firstPart = qMin(mSize, mColumnCount-mFirstColumn);
+  painter->drawImage(QRectF(0, 0, mRowCount, firstPart), mImage, QRectF(0, mFirstColumn, mRowCount, firstPart));
+  if (mSize > firstPart)
+    painter->drawImage(QRectF(0, firstPart, mRowCount, mSize-firstPart), mImage, QRectF(0, 0, mRowCount, mSize-firstPart));
+  painter->restore();
+}
+
+/* inherits documentation from base class */
+void QCPWaterfall::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
+{
+  // draw the gradient from the lower to the upper end of the data range:
+  const int width = qMax(1, qRound(rect.width()));
+  QVector<double> positions(width);
+  for (int i=0; i<width; ++i)
+    positions[i] = (i+0.5)/width;
+  QImage icon(width, 1, QImage::Format_ARGB32_Premultiplied);
+  QCPColorGradient gradient(mGradient); // colorize may update the color buffer, so this const method works on a copy
+  gradient.colorize(positions.constData(), QCPRange(0, 1), reinterpret_cast<QRgb*>(icon.scanLine(0)), width);
+  painter->drawImage(rect, icon);
+}
+
+/*! \internal
+  
+  Brings \a mImage up to date with the data. Normally only the columns added since the last call
+  are colorized. If the image had to be recreated or was invalidated (e.g. by \ref setDataRange),
+  all columns are colorized.
+*/
+void QCPWaterfall::updateImage()
+{
+  if (mImage.width() != mRowCount || mImage.height() != mColumnCount)
+  {
+    mImage = QImage(QSize(mRowCount, mColumnCount), QImage::Format_ARGB32_Premultiplied);
+    mImageInvalidated = true;
+  }
+  if (mImage.isNull())
+  {
+    qDebug() << Q_FUNC_INFO << "Couldn't create waterfall image (possibly too large for memory)";
+    return;
+  }
+  
+  const int count = mImageInvalidated ? mSize : qMin(mUncolorizedColumns, mSize);
+  for (int i=mSize-count; i<mSize; ++i)
+    colorizeColumn((mFirstColumn+i)%mColumnCount);
+  mUncolorizedColumns = 0;
+  mImageInvalidated = false;
+}
+
+/*! \internal
+  
+  Colorizes the column in ring buffer slot \a slot into the scan line of \a mImage with the same
+  index.
+*/
+void QCPWaterfall::colorizeColumn(int slot)
+{
+  QRgb *pixels = reinterpret_cast<QRgb*>(mImage.scanLine(slot));
+  mGradient.colorize(mData.constData()+slot*mRowCount, mDataRange, pixels, mRowCount, 1, mDataScaleType==QCPAxis::stLogarithmic);
+}
+
+/*! \internal
+  
+  Returns the average distance between the keys of consecutive columns, or 0 if fewer than two
+  columns are held.
+*/
+double QCPWaterfall::columnSpacing() const
+{
+  if (mSize < 2)
+    return 0;
+  return (mKeys.at((mFirstColumn+mSize-1)%mColumnCount)-mKeys.at(mFirstColumn))/(mSize-1);
+}
 /* end of 'src/plottables/plottable-colormap.cpp' */
 
 
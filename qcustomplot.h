@@ -41,6 +41,10 @@
 #  endif
 #endif
 
+#if defined(QCUSTOMPLOT_USE_CONCURRENT) && QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+#  define QCP_CONCURRENT
+#endif
+
 #if QT_VERSION >= QT_VERSION_CHECK(5, 4, 0)
 #  define QCP_DEVICEPIXELRATIO_SUPPORTED
 #  if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
@@ -72,6 +76,8 @@
 #ifdef QCP_OPENGL_FBO
 #  include <QtGui/QOpenGLContext>
 #  include <QtGui/QOpenGLFramebufferObject>
+#  include <QtGui/QOpenGLBuffer>
+#  include <QtGui/QOpenGLShaderProgram>
 #  ifdef QCP_OPENGL_OFFSCREENSURFACE
 #    include <QtGui/QOffscreenSurface>
 #  else
@@ -81,6 +87,10 @@
 #ifdef QCP_OPENGL_PBUFFER
 #  include <QtOpenGL/QGLPixelBuffer>
 #endif
+#ifdef QCP_CONCURRENT
+#  include <QtCore/QThread>
+#  include <QtConcurrent/QtConcurrentMap>
+#endif
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
 #  include <qnumeric.h>
 #  include <QtGui/QWidget>
@@ -112,6 +122,9 @@ class QCPSelectionRect;
 class QCPColorMap;
 class QCPColorScale;
 class QCPBars;
+#ifdef QCP_OPENGL_FBO
+class QCPGlLineRenderer;
+#endif
 
 /* including file 'src/global.h', size 16225                                 */
 /* commit 9868e55d3b412f2f89766bb482fcf299e93a0988 2017-09-04 01:56:22 +0200 */
@@ -239,6 +252,10 @@ enum PlottingHint { phNone              = 0x000 ///< <tt>0x000</tt> No hints are
                     ,phImmediateRefresh = 0x002 ///< <tt>0x002</tt> causes an immediate repaint() instead of a soft update() when QCustomPlot::replot() is called with parameter \ref QCustomPlot::rpRefreshHint.
                                                 ///<                This is set by default to prevent the plot from freezing on fast consecutive replots (e.g. user drags ranges with mouse).
                     ,phCacheLabels      = 0x004 ///< <tt>0x004</tt> axis (tick) labels will be cached as pixmaps, increasing replot performance.
+                    ,phImageBuffers     = 0x008 ///< <tt>0x008</tt> the paint buffers are QImages instead of QPixmaps (see \ref QCPPaintBufferImage), so the plot may be replotted outside the GUI thread.
+                                                ///<                Label caching (\ref phCacheLabels) must be disabled for that, since the label cache holds pixmaps.
+                    ,phGlLines          = 0x010 ///< <tt>0x010</tt> if OpenGL is enabled (\ref QCustomPlot::setOpenGl), graph lines are drawn from vertex buffers kept on the GPU instead of
+                                                ///<                being tessellated by QPainter, see \ref QCPGlLineRenderer. Graphs this renderer can't represent are drawn with QPainter as usual.
                   };
 Q_DECLARE_FLAGS(PlottingHints, PlottingHint)
 
@@ -534,6 +551,7 @@ public:
   virtual void donePainting() {}
   virtual void draw(QCPPainter *painter) const = 0;
   virtual void clear(const QColor &color) = 0;
+  virtual bool scroll(int dx, int dy, const QRect &rect);
   
 protected:
   // property members:
@@ -558,6 +576,7 @@ public:
   virtual QCPPainter *startPainting() Q_DECL_OVERRIDE;
   virtual void draw(QCPPainter *painter) const Q_DECL_OVERRIDE;
   void clear(const QColor &color) Q_DECL_OVERRIDE;
+  virtual bool scroll(int dx, int dy, const QRect &rect) Q_DECL_OVERRIDE;
   
 protected:
   // non-property members:
@@ -568,6 +587,27 @@ protected:
 };
 
 
+class QCP_LIB_DECL QCPPaintBufferImage : public QCPAbstractPaintBuffer
+{
+public:
+  explicit QCPPaintBufferImage(const QSize &size, double devicePixelRatio);
+  virtual ~QCPPaintBufferImage();
+  
+  // reimplemented virtual methods:
+  virtual QCPPainter *startPainting() Q_DECL_OVERRIDE;
+  virtual void draw(QCPPainter *painter) const Q_DECL_OVERRIDE;
+  void clear(const QColor &color) Q_DECL_OVERRIDE;
+  virtual bool scroll(int dx, int dy, const QRect &rect) Q_DECL_OVERRIDE;
+  
+protected:
+  // non-property members:
+  QImage mBuffer;
+  
+  // reimplemented virtual methods:
+  virtual void reallocateBuffer() Q_DECL_OVERRIDE;
+};
+
+
 #ifdef QCP_OPENGL_PBUFFER
 class QCP_LIB_DECL QCPPaintBufferGlPbuffer : public QCPAbstractPaintBuffer
 {
@@ -677,8 +717,8 @@ protected:
   QWeakPointer<QCPAbstractPaintBuffer> mPaintBuffer;
   
   // non-virtual methods:
-  void draw(QCPPainter *painter);
-  void drawToPaintBuffer();
+  void draw(QCPPainter *painter, const QRect &clipRect=QRect());
+  void drawToPaintBuffer(const QRect &clipRect=QRect());
   void addChild(QCPLayerable *layerable, bool prepend);
   void removeChild(QCPLayerable *layerable);
   
@@ -2414,9 +2454,13 @@ public:
   int size() const { return mData.size()-mPreallocSize; }
   bool isEmpty() const { return size() == 0; }
   bool autoSqueeze() const { return mAutoSqueeze; }
+  int capacity() const { return mCapacity; }
+  quint64 revision() const { return mRevision; }
+  int storageOffset() const { return mPreallocSize; }
   
   // setters:
   void setAutoSqueeze(bool enabled);
+  void setCapacity(int capacity);
   
   // non-virtual methods:
   void set(const QCPDataContainer<DataType> &data);
@@ -2424,6 +2468,7 @@ public:
   void add(const QCPDataContainer<DataType> &data);
   void add(const QVector<DataType> &data, bool alreadySorted=false);
   void add(const DataType &data);
+  void add(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
   void removeBefore(double sortKey);
   void removeAfter(double sortKey);
   void remove(double sortKeyFrom, double sortKeyTo);
@@ -2434,28 +2479,44 @@ public:
   
   const_iterator constBegin() const { return mData.constBegin()+mPreallocSize; }
   const_iterator constEnd() const { return mData.constEnd(); }
-  iterator begin() { return mData.begin()+mPreallocSize; }
-  iterator end() { return mData.end(); }
+  iterator begin() { invalidateSummary(); return mData.begin()+mPreallocSize; }
+  iterator end() { invalidateSummary(); return mData.end(); }
   const_iterator findBegin(double sortKey, bool expandedRange=true) const;
   const_iterator findEnd(double sortKey, bool expandedRange=true) const;
   const_iterator at(int index) const { return constBegin()+qBound(0, index, size()); }
   QCPRange keyRange(bool &foundRange, QCP::SignDomain signDomain=QCP::sdBoth);
   QCPRange valueRange(bool &foundRange, QCP::SignDomain signDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange());
+  QCPRange valueRange(const_iterator begin, const_iterator end, bool &foundRange) const;
+  void valueSpans(const_iterator begin, const_iterator end, const QCPRange &valueRange, QVector<QCPDataRange> &spans) const;
   QCPDataRange dataRange() const { return QCPDataRange(0, size()); }
   void limitIteratorsToDataRange(const_iterator &begin, const_iterator &end, const QCPDataRange &dataRange) const;
   
 protected:
   // property members:
   bool mAutoSqueeze;
+  int mCapacity;
   
   // non-property memebers:
   QVector<DataType> mData;
   int mPreallocSize;
   int mPreallocIteration;
+  quint64 mRevision; // changes whenever existing data may have moved or changed, see revision
+  
+  // value summary of fixed blocks of mData, see syncSummary:
+  enum { SummaryBlockSize = 64, SummaryFanOut = 4 };
+  struct SummaryBlock { double lower, upper; bool hasNaN; };
+  mutable QVector<QVector<SummaryBlock> > mSummary;
   
   // non-virtual methods:
   void preallocateGrow(int minimumPreallocSize);
   void performAutoSqueeze();
+  void enforceCapacity();
+  void invalidateSummary() { mSummary.clear(); ++mRevision; }
+  void syncSummary() const;
+  void summarizeRaw(int from, int to, SummaryBlock &block) const;
+  void collectSpans(int level, int blockFrom, int blockTo, int from, int to, const QCPRange &valueRange, QVector<QCPDataRange> &spans) const;
+  void collectSpansRaw(int from, int to, const QCPRange &valueRange, QVector<QCPDataRange> &spans) const;
+  void appendSpan(int from, int to, QVector<QCPDataRange> &spans) const;
 };
 
 // include implementation in header since it is a class template:
@@ -2496,6 +2557,20 @@ protected:
   sort. Failing to do so can not be detected by the container efficiently and will cause both
   rendering artifacts and potential data loss.
 
+  For streaming applications where only the most recent data is of interest, a capacity can be set
+  with \ref setCapacity. The container then keeps at most that many data points, discarding the
+  ones with the smallest sort keys as new data is added. Discarding is O(1) per added data point
+  (amortized), and the stored data stays one contiguous sorted block, so the iterators, \ref
+  findBegin and \ref findEnd work exactly as without capacity.
+
+  For quick value range queries over arbitrarily large index spans (\ref valueRange(const_iterator,
+  const_iterator, bool&) const), the container maintains a multi-resolution summary of the value
+  ranges of fixed blocks of data points. It is updated lazily upon the next query: appended data
+  only costs amortized O(1) per data point, while any other modification (including the use of the
+  non-const iterators) discards the summary, so it is rebuilt on the next query. The same summary
+  serves as a spatial index for hit testing: \ref valueSpans finds the data points within a value
+  range by skipping whole blocks that lie entirely above or below it.
+
   Implementing one-dimensional plottables that make use of a \ref QCPDataContainer<T> is usually
   done by subclassing from \ref QCPAbstractPlottable1D "QCPAbstractPlottable1D<T>", which
   introduces an according \a mDataContainer member and some convenience methods.
@@ -2546,6 +2621,26 @@ protected:
   Returns whether this container holds no data points.
 */
 
+/*! \fn quint64 QCPDataContainer<DataType>::revision() const
+  
+  Returns a counter that changes whenever data points already held by this container may have been
+  moved or modified, e.g. by inserting, sorting, removing data in the middle or at the end, or
+  handing out non-const iterators (\ref begin, \ref end). Appending data points with larger sort
+  keys and discarding data at the front (\ref removeBefore, \ref setCapacity) leave it unchanged.
+  
+  Together with \ref storageOffset, this allows mirrors of the data outside the container (e.g.
+  vertex buffers on the GPU, see \ref QCPGlLineRenderer) to be updated incrementally: as long as the
+  revision is the same, only the data points past the mirrored ones need to be copied.
+*/
+
+/*! \fn int QCPDataContainer<DataType>::storageOffset() const
+  
+  Returns the position of \ref constBegin within the container's internal storage. Storage
+  positions of data points stay the same as long as \ref revision doesn't change, even when data is
+  discarded at the front, so the storage position of the data point at \ref constBegin + \a i is
+  \ref storageOffset + \a i.
+*/
+
 /*! \fn QCPDataContainer::const_iterator QCPDataContainer<DataType>::constBegin() const
   
   Returns a const iterator to the first data point in this container.
@@ -2563,6 +2658,10 @@ protected:
   You can manipulate the data points in-place through the non-const iterators, but great care must
   be taken when manipulating the sort key of a data point, see \ref sort, or the detailed
   description of this class.
+  
+  Since the data may be modified through the returned iterator, calling this method discards the
+  value summary (see \ref valueRange(const_iterator, const_iterator, bool&) const). Prefer \ref
+  constBegin for read-only access.
 */
 
 /*! \fn QCPDataContainer::iterator QCPDataContainer<DataType>::end() const
@@ -2599,8 +2698,10 @@ protected:
 template <class DataType>
 QCPDataContainer<DataType>::QCPDataContainer() :
   mAutoSqueeze(true),
+  mCapacity(0),
   mPreallocSize(0),
-  mPreallocIteration(0)
+  mPreallocIteration(0),
+  mRevision(0)
 {
 }
 
@@ -2623,6 +2724,28 @@ void QCPDataContainer<DataType>::setAutoSqueeze(bool enabled)
   }
 }
 
+/*!
+  Limits the number of data points held by this container to \a capacity. Whenever data is added
+  and the size would exceed \a capacity, the data points with the smallest sort keys are
+  discarded. For data that is appended in ascending key order (e.g. a stream of real time
+  samples), this makes the container a ring buffer of the most recent \a capacity data points:
+  memory stays bounded at roughly twice \a capacity and each append costs amortized O(1), no
+  matter how long the stream runs.
+
+  Internally, discarded data points are added to the preallocation pool like in \ref
+  removeBefore, and the pool is recycled in one block copy once it has grown as large as \a
+  capacity.
+
+  A \a capacity of 0 (the default) means the container is unbounded. If the container currently
+  holds more than \a capacity data points, the excess ones are discarded immediately.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::setCapacity(int capacity)
+{
+  mCapacity = qMax(0, capacity);
+  enforceCapacity();
+}
+
 /*! \overload
   
   Replaces the current data in this container with the provided \a data.
@@ -2651,8 +2774,10 @@ void QCPDataContainer<DataType>::set(const QVector<DataType> &data, bool already
   mData = data;
   mPreallocSize = 0;
   mPreallocIteration = 0;
+  invalidateSummary();
   if (!alreadySorted)
     sort();
+  enforceCapacity();
 }
 
 /*! \overload
@@ -2679,10 +2804,11 @@ void QCPDataContainer<DataType>::add(const QCPDataContainer<DataType> &data)
   } else // don't need to prepend, so append and merge if necessary
   {
     mData.resize(mData.size()+n);
-    std::copy(data.constBegin(), data.constEnd(), end()-n);
+    std::copy(data.constBegin(), data.constEnd(), mData.end()-n);
     if (oldSize > 0 && !qcpLessThanSortKey<DataType>(*(constEnd()-n-1), *(constEnd()-n))) // if appended range keys aren't all greater than existing ones, merge the two partitions
       std::inplace_merge(begin(), end()-n, end(), qcpLessThanSortKey<DataType>);
   }
+  enforceCapacity();
 }
 
 /*!
@@ -2716,12 +2842,68 @@ void QCPDataContainer<DataType>::add(const QVector<DataType> &data, bool already
   } else // don't need to prepend, so append and then sort and merge if necessary
   {
     mData.resize(mData.size()+n);
-    std::copy(data.constBegin(), data.constEnd(), end()-n);
+    std::copy(data.constBegin(), data.constEnd(), mData.end()-n);
+    if (!alreadySorted) // sort appended subrange if it wasn't already sorted
+      std::sort(mData.end()-n, mData.end(), qcpLessThanSortKey<DataType>);
+    if (oldSize > 0 && !qcpLessThanSortKey<DataType>(*(constEnd()-n-1), *(constEnd()-n))) // if appended range keys aren't all greater than existing ones, merge the two partitions
+      std::inplace_merge(begin(), end()-n, end(), qcpLessThanSortKey<DataType>);
+  }
+  enforceCapacity();
+}
+
+/*! \overload
+  
+  Adds the data points given as separate \a keys and \a values columns to the current data. The
+  points are written directly into the container's storage, so unlike building a temporary
+  QVector<DataType> and passing it to \ref add(const QVector<DataType> &data, bool alreadySorted),
+  no intermediate copy of the data is made.
+  
+  This overload is only available for data types that consist of public \a key and \a value
+  members, e.g. \ref QCPGraphData and \ref QCPBarsData. If \a keys and \a values differ in size,
+  the surplus entries of the longer vector are ignored.
+  
+  If you can guarantee that \a keys are in ascending order, set \a alreadySorted to true to avoid an
+  unnecessary sorting run.
+  
+  \see set, remove
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::add(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted)
+{
+  const int n = qMin(keys.size(), values.size());
+  if (n == 0)
+    return;
+  
+  const int oldSize = size();
+  const double *key = keys.constData();
+  const double *value = values.constData();
+  
+  if (alreadySorted && oldSize > 0 && !(constBegin()->sortKey() < keys.at(n-1))) // prepend if new keys are sorted and all smaller than or equal to existing ones
+  {
+    if (mPreallocSize < n)
+      preallocateGrow(n);
+    mPreallocSize -= n;
+    iterator it = begin();
+    for (int i=0; i<n; ++i, ++it)
+    {
+      it->key = key[i];
+      it->value = value[i];
+    }
+  } else // don't need to prepend, so append and then sort and merge if necessary
+  {
+    mData.resize(mData.size()+n);
+    typename QVector<DataType>::iterator it = mData.end()-n; // write through mData so the summary of the existing points stays valid
+    for (int i=0; i<n; ++i, ++it)
+    {
+      it->key = key[i];
+      it->value = value[i];
+    }
     if (!alreadySorted) // sort appended subrange if it wasn't already sorted
       std::sort(end()-n, end(), qcpLessThanSortKey<DataType>);
     if (oldSize > 0 && !qcpLessThanSortKey<DataType>(*(constEnd()-n-1), *(constEnd()-n))) // if appended range keys aren't all greater than existing ones, merge the two partitions
       std::inplace_merge(begin(), end()-n, end(), qcpLessThanSortKey<DataType>);
   }
+  enforceCapacity();
 }
 
 /*! \overload
@@ -2747,6 +2929,7 @@ void QCPDataContainer<DataType>::add(const DataType &data)
     QCPDataContainer<DataType>::iterator insertionPoint = std::lower_bound(begin(), end(), data, qcpLessThanSortKey<DataType>);
     mData.insert(insertionPoint, data);
   }
+  enforceCapacity();
 }
 
 /*!
@@ -2757,8 +2940,8 @@ void QCPDataContainer<DataType>::add(const DataType &data)
 template <class DataType>
 void QCPDataContainer<DataType>::removeBefore(double sortKey)
 {
-  QCPDataContainer<DataType>::iterator it = begin();
-  QCPDataContainer<DataType>::iterator itEnd = std::lower_bound(begin(), end(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
+  QCPDataContainer<DataType>::const_iterator it = constBegin();
+  QCPDataContainer<DataType>::const_iterator itEnd = std::lower_bound(constBegin(), constEnd(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
   mPreallocSize += itEnd-it; // don't actually delete, just add it to the preallocated block (if it gets too large, squeeze will take care of it)
   if (mAutoSqueeze)
     performAutoSqueeze();
@@ -2834,6 +3017,7 @@ void QCPDataContainer<DataType>::clear()
   mData.clear();
   mPreallocIteration = 0;
   mPreallocSize = 0;
+  invalidateSummary();
 }
 
 /*!
@@ -3070,6 +3254,12 @@ QCPRange QCPDataContainer<DataType>::keyRange(bool &foundRange, QCP::SignDomain
   relevant e.g. for logarithmic plots which can mathematically only display one sign domain at a
   time.
 
+  Whenever the considered data points form a contiguous span of the container (always the case if
+  the DataType's sort key is its main key), the range is taken from the container's value summary
+  in O(log n), see \ref valueRange(const_iterator begin, const_iterator end, bool &foundRange) const.
+  This makes it cheap to call for continuous axis rescaling. Only sign-restricted queries on data
+  that crosses zero fall back to visiting every data point.
+
   \see keyRange
 */
 template <class DataType>
@@ -3089,8 +3279,21 @@ QCPRange QCPDataContainer<DataType>::valueRange(bool &foundRange, QCP::SignDomai
   QCPDataContainer<DataType>::const_iterator itEnd = constEnd();
   if (DataType::sortKeyIsMainKey() && restrictKeyRange)
   {
-    itBegin = findBegin(inKeyRange.lower);
-    itEnd = findEnd(inKeyRange.upper);
+    itBegin = findBegin(inKeyRange.lower, false);
+    itEnd = findEnd(inKeyRange.upper, false);
+  }
+  if (DataType::sortKeyIsMainKey() || !restrictKeyRange) // points in question form one contiguous span, so the value summary can answer in O(log n)
+  {
+    bool foundSummaryRange = false;
+    const QCPRange summaryRange = valueRange(itBegin, itEnd, foundSummaryRange);
+    if (!foundSummaryRange || signDomain == QCP::sdBoth ||
+        (signDomain == QCP::sdNegative && summaryRange.upper < 0) ||
+        (signDomain == QCP::sdPositive && summaryRange.lower > 0))
+    {
+      foundRange = foundSummaryRange;
+      return summaryRange;
+    }
+    // values cross zero, so the sign restricted range must be found by visiting the points below
   }
   if (signDomain == QCP::sdBoth) // range may be anywhere
   {
@@ -3169,6 +3372,109 @@ void QCPDataContainer<DataType>::limitIteratorsToDataRange(const_iterator &begin
   end = constBegin()+iteratorRange.end();
 }
 
+/*! \overload
+
+  Returns the range encompassed by the \a DataType::valueRange of the data points from \a begin up
+  to (but not including) \a end. Data points with NaN values are ignored. The output parameter \a
+  foundRange indicates whether any data point with a valid value was found.
+
+  Unlike \ref valueRange(bool &foundRange, QCP::SignDomain signDomain, const QCPRange &inKeyRange),
+  this method doesn't visit every data point. It combines the precomputed value ranges of the
+  largest blocks that fit into the span and only scans the partial blocks at its borders, so the
+  cost is O(log n) regardless of the distance between \a begin and \a end. This makes it suitable
+  for per-pixel min/max decimation of large data sets (see \ref QCPGraph::setAdaptiveSampling).
+
+  \a begin and \a end must be valid iterators of this container with \a begin not after \a end.
+*/
+template <class DataType>
+QCPRange QCPDataContainer<DataType>::valueRange(const_iterator begin, const_iterator end, bool &foundRange) const
+{
+  syncSummary();
+  int from = begin-mData.constBegin();
+  int to = end-mData.constBegin();
+  SummaryBlock result;
+  result.lower = std::numeric_limits<double>::infinity();
+  result.upper = -std::numeric_limits<double>::infinity();
+  result.hasNaN = false;
+  
+  int blockFrom = (from+SummaryBlockSize-1)/SummaryBlockSize;
+  int blockTo = to/SummaryBlockSize;
+  if (blockFrom >= blockTo) // span doesn't cover a complete block
+  {
+    summarizeRaw(from, to, result);
+  } else
+  {
+    summarizeRaw(from, blockFrom*SummaryBlockSize, result);
+    summarizeRaw(blockTo*SummaryBlockSize, to, result);
+    // climb the levels, consuming the blocks that don't align with the next coarser level:
+    int level = 0;
+    while (blockFrom < blockTo)
+    {
+      const QVector<SummaryBlock> &blocks = mSummary.at(level);
+      const bool topLevel = level+1 >= mSummary.size();
+      while (blockFrom < blockTo && (topLevel || blockFrom % SummaryFanOut != 0))
+      {
+        result.lower = qMin(result.lower, blocks.at(blockFrom).lower);
+        result.upper = qMax(result.upper, blocks.at(blockFrom).upper);
+        ++blockFrom;
+      }
+      while (blockFrom < blockTo && blockTo % SummaryFanOut != 0)
+      {
+        --blockTo;
+        result.lower = qMin(result.lower, blocks.at(blockTo).lower);
+        result.upper = qMax(result.upper, blocks.at(blockTo).upper);
+      }
+      blockFrom /= SummaryFanOut;
+      blockTo /= SummaryFanOut;
+      ++level;
+    }
+  }
+  
+  foundRange = result.lower <= result.upper;
+  if (!foundRange)
+    return QCPRange();
+  return QCPRange(result.lower, result.upper);
+}
+
+/*!
+  Appends to \a spans the index ranges of the data points from \a begin up to (but not including)
+  \a end whose \a DataType::mainValue lies within \a valueRange. The ranges are given as indices
+  relative to \ref constBegin, in ascending order, and adjacent ranges are joined. Data points with
+  NaN values are never included.
+
+  The query descends the value summary (see \ref valueRange(const_iterator, const_iterator, bool&)
+  const): blocks whose value range lies entirely outside \a valueRange are skipped and blocks lying
+  entirely inside are taken whole, so only the blocks that straddle a border of \a valueRange are
+  inspected more closely. The cost therefore depends on how often the data crosses the borders of
+  \a valueRange rather than on the number of data points. This requires the \a
+  DataType::mainValue of each data point to lie within its \a DataType::valueRange, which is the
+  case for all data types shipped with QCustomPlot.
+
+  Together with \ref findBegin and \ref findEnd, this allows finding the data points inside a
+  rectangle of key and value coordinates without visiting every data point in its key range, see
+  \ref QCPAbstractPlottable1D::selectTestRect.
+
+  \a begin and \a end must be valid iterators of this container with \a begin not after \a end.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::valueSpans(const_iterator begin, const_iterator end, const QCPRange &valueRange, QVector<QCPDataRange> &spans) const
+{
+  syncSummary();
+  const int from = begin-mData.constBegin();
+  const int to = end-mData.constBegin();
+  if (from >= to)
+    return;
+  
+  // walk the levels from the top down, each level covering the blocks its parent level left over:
+  int blockFrom = 0;
+  for (int level=mSummary.size()-1; level>=0; --level)
+  {
+    collectSpans(level, blockFrom, mSummary.at(level).size(), from, to, valueRange, spans);
+    blockFrom = mSummary.at(level).size()*SummaryFanOut;
+  }
+  collectSpansRaw(qMax(from, mSummary.at(0).size()*SummaryBlockSize), to, valueRange, spans);
+}
+
 /*! \internal
   
   Increases the preallocation pool to have a size of at least \a minimumPreallocSize. Depending on
@@ -3189,6 +3495,7 @@ void QCPDataContainer<DataType>::preallocateGrow(int minimumPreallocSize)
   ++mPreallocIteration;
   
   int sizeDifference = newPreallocSize-mPreallocSize;
+  invalidateSummary();
   mData.resize(mData.size()+sizeDifference);
   std::copy_backward(mData.begin()+mPreallocSize, mData.end()-sizeDifference, mData.end());
   mPreallocSize = newPreallocSize;
@@ -3229,6 +3536,189 @@ void QCPDataContainer<DataType>::performAutoSqueeze()
   if (shrinkPreAllocation || shrinkPostAllocation)
     squeeze(shrinkPreAllocation, shrinkPostAllocation);
 }
+
+/*! \internal
+
+  If a capacity is set (see \ref setCapacity) and exceeded, discards the data points with the
+  smallest sort keys by moving them into the preallocation pool. Once that pool is as large as the
+  capacity, the remaining data is moved back to the front of the internal vector in one block copy.
+  The vector's allocation is kept, so a container at its capacity stops allocating altogether and
+  every added data point costs amortized O(1).
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::enforceCapacity()
+{
+  if (mCapacity <= 0 || size() <= mCapacity)
+    return;
+  
+  mPreallocSize += size()-mCapacity;
+  if (mPreallocSize >= mCapacity)
+  {
+    std::copy(begin(), end(), mData.begin());
+    mData.resize(size()); // since Qt 5.6, shrinking doesn't release the allocation
+    mPreallocSize = 0;
+    mPreallocIteration = 0;
+  }
+}
+
+/*! \internal
+
+  Brings the value summary up to date with the data. The summary is a pyramid of levels: level 0
+  holds the value range of every complete block of \c SummaryBlockSize consecutive elements of the
+  internal vector, and each further level merges \c SummaryFanOut blocks of the level below. The
+  blocks are aligned to the internal vector, not to \ref constBegin, so discarding data at the
+  front (\ref removeBefore, \ref setCapacity) leaves the existing blocks valid. Blocks straddling
+  the front are never used whole by \ref valueRange(const_iterator, const_iterator, bool&) const.
+
+  Only the blocks that were completed since the last call are computed, so a stream of appended data
+  costs amortized O(1) per data point. Modifications that move or change existing data discard the
+  summary via \ref invalidateSummary, causing a full rebuild here.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::syncSummary() const
+{
+  int blockCount = mData.size()/SummaryBlockSize;
+  if (!mSummary.isEmpty() && mSummary.at(0).size() > blockCount) // data shrunk behind our back, start over
+    mSummary.clear();
+  if (mSummary.isEmpty())
+    mSummary.append(QVector<SummaryBlock>());
+  
+  int dirtyFrom = mSummary.at(0).size();
+  if (dirtyFrom == blockCount)
+    return;
+  QVector<SummaryBlock> &baseLevel = mSummary[0];
+  baseLevel.resize(blockCount);
+  for (int i=dirtyFrom; i<blockCount; ++i)
+  {
+    baseLevel[i].lower = std::numeric_limits<double>::infinity();
+    baseLevel[i].upper = -std::numeric_limits<double>::infinity();
+    baseLevel[i].hasNaN = false;
+    summarizeRaw(i*SummaryBlockSize, (i+1)*SummaryBlockSize, baseLevel[i]);
+  }
+  
+  // propagate the new blocks up the coarser levels:
+  for (int level=1; blockCount >= SummaryFanOut; ++level)
+  {
+    if (mSummary.size() <= level)
+      mSummary.append(QVector<SummaryBlock>());
+    const QVector<SummaryBlock> &children = mSummary.at(level-1);
+    QVector<SummaryBlock> &parents = mSummary[level];
+    const int parentCount = blockCount/SummaryFanOut;
+    const int parentFrom = qMin(parents.size(), dirtyFrom/SummaryFanOut);
+    parents.resize(parentCount);
+    for (int i=parentFrom; i<parentCount; ++i)
+    {
+      SummaryBlock block = children.at(i*SummaryFanOut);
+      for (int k=1; k<SummaryFanOut; ++k)
+      {
+        block.lower = qMin(block.lower, children.at(i*SummaryFanOut+k).lower);
+        block.upper = qMax(block.upper, children.at(i*SummaryFanOut+k).upper);
+        block.hasNaN = block.hasNaN || children.at(i*SummaryFanOut+k).hasNaN;
+      }
+      parents[i] = block;
+    }
+    dirtyFrom = parentFrom;
+    blockCount = parentCount;
+  }
+}
+
+/*! \internal
+
+  Expands \a block by the value ranges of the elements \a from up to (but not including) \a to of
+  the internal vector, ignoring NaN values. If any NaN values are encountered, the \a hasNaN flag
+  of \a block is set.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::summarizeRaw(int from, int to, SummaryBlock &block) const
+{
+  typename QVector<DataType>::const_iterator it = mData.constBegin()+from;
+  typename QVector<DataType>::const_iterator itEnd = mData.constBegin()+to;
+  while (it != itEnd)
+  {
+    const QCPRange current = it->valueRange();
+    if (current.lower < block.lower) // false for NaN
+      block.lower = current.lower;
+    if (current.upper > block.upper)
+      block.upper = current.upper;
+    else if (qIsNaN(current.upper))
+      block.hasNaN = true;
+    ++it;
+  }
+}
+
+/*! \internal
+
+  Helper of \ref valueSpans that handles the blocks \a blockFrom up to (but not including) \a
+  blockTo of summary level \a level, restricted to the elements \a from up to (but not including)
+  \a to of the internal vector. Blocks are visited in ascending order, so \a spans stays sorted.
+  Blocks that are only partially covered or that straddle a border of \a valueRange are split
+  into their child blocks, down to the individual elements at the lowest level.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::collectSpans(int level, int blockFrom, int blockTo, int from, int to, const QCPRange &valueRange, QVector<QCPDataRange> &spans) const
+{
+  int blockSize = SummaryBlockSize;
+  for (int i=0; i<level; ++i)
+    blockSize *= SummaryFanOut;
+  blockFrom = qMax(blockFrom, from/blockSize);
+  blockTo = qMin(blockTo, (to+blockSize-1)/blockSize);
+  
+  const QVector<SummaryBlock> &blocks = mSummary.at(level);
+  for (int i=blockFrom; i<blockTo; ++i)
+  {
+    const SummaryBlock &block = blocks.at(i);
+    if (block.upper < valueRange.lower || block.lower > valueRange.upper) // no element inside valueRange (also true for all-NaN blocks)
+      continue;
+    const int blockBegin = i*blockSize;
+    const int blockEnd = blockBegin+blockSize;
+    if (blockBegin >= from && blockEnd <= to && !block.hasNaN && block.lower >= valueRange.lower && block.upper <= valueRange.upper)
+      appendSpan(blockBegin, blockEnd, spans);
+    else if (level > 0)
+      collectSpans(level-1, i*SummaryFanOut, (i+1)*SummaryFanOut, from, to, valueRange, spans);
+    else
+      collectSpansRaw(qMax(from, blockBegin), qMin(to, blockEnd), valueRange, spans);
+  }
+}
+
+/*! \internal
+
+  Helper of \ref valueSpans that checks the elements \a from up to (but not including) \a to of
+  the internal vector individually.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::collectSpansRaw(int from, int to, const QCPRange &valueRange, QVector<QCPDataRange> &spans) const
+{
+  int spanBegin = -1; // -1 means we're currently not in a span
+  for (int i=from; i<to; ++i)
+  {
+    const bool inside = valueRange.contains(mData.at(i).mainValue()); // false for NaN
+    if (inside && spanBegin == -1)
+    {
+      spanBegin = i;
+    } else if (!inside && spanBegin != -1)
+    {
+      appendSpan(spanBegin, i, spans);
+      spanBegin = -1;
+    }
+  }
+  if (spanBegin != -1)
+    appendSpan(spanBegin, to, spans);
+}
+
+/*! \internal
+
+  Appends the elements \a from up to (but not including) \a to of the internal vector to \a
+  spans as a range of indices relative to \ref constBegin, joining it with the last range of \a
+  spans if the two are adjacent.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::appendSpan(int from, int to, QVector<QCPDataRange> &spans) const
+{
+  if (!spans.isEmpty() && spans.last().end() == from-mPreallocSize)
+    spans.last().setEnd(to-mPreallocSize);
+  else
+    spans.append(QCPDataRange(from-mPreallocSize, to-mPreallocSize));
+}
 /* end of 'src/datacontainer.cpp' */
 
 
@@ -3615,6 +4105,7 @@ public:
                          ,rpQueuedRefresh   ///< Replots immediately, but queues the widget repaint, by calling QWidget::update() after the replot. This way multiple redundant widget repaints can be avoided.
                          ,rpRefreshHint     ///< Whether to use immediate or queued refresh depends on whether the plotting hint \ref QCP::phImmediateRefresh is set, see \ref setPlottingHints.
                          ,rpQueuedReplot    ///< Queues the entire replot for the next event loop iteration. This way multiple redundant replots can be avoided. The actual replot is then done with \ref rpRefreshHint priority.
+                         ,rpNoRefresh       ///< Replots immediately, but doesn't touch the widget. The caller is responsible for calling QWidget::update() afterwards, from the GUI thread. This is used to replot in worker threads, see \ref QCP::phImageBuffers.
                        };
   Q_ENUMS(RefreshPriority)
   
@@ -3728,6 +4219,8 @@ public:
   QPixmap toPixmap(int width=0, int height=0, double scale=1.0);
   void toPainter(QCPPainter *painter, int width=0, int height=0);
   Q_SLOT void replot(QCustomPlot::RefreshPriority refreshPriority=QCustomPlot::rpRefreshHint);
+  void scrollReplot(QCPLayer *layer, QCPAxis *keyAxis, double dirtyFromKey=std::numeric_limits<double>::quiet_NaN(), QCustomPlot::RefreshPriority refreshPriority=QCustomPlot::rpRefreshHint);
+  void snapScrollRange(QCPAxis *keyAxis);
   
   QCPAxis *xAxis, *yAxis, *xAxis2, *yAxis2;
   QCPLegend *legend;
@@ -3788,6 +4281,10 @@ protected:
   QVariant mMouseSignalLayerableDetails;
   bool mReplotting;
   bool mReplotQueued;
+  QPointer<QCPLayer> mScrollLayer; // state of the last frame drawn by scrollReplot, reset by other replots
+  QPointer<QCPAxis> mScrollKeyAxis;
+  QRect mScrollRect;
+  QList<QCPRange> mScrollAxisRanges;
   int mOpenGlMultisamples;
   QCP::AntialiasedElements mOpenGlAntialiasedElementsBackup;
   bool mOpenGlCacheLabelsBackup;
@@ -3795,6 +4292,7 @@ protected:
   QSharedPointer<QOpenGLContext> mGlContext;
   QSharedPointer<QSurface> mGlSurface;
   QSharedPointer<QOpenGLPaintDevice> mGlPaintDevice;
+  QCPGlLineRenderer *mGlLineRenderer;
 #endif
   
   // reimplemented virtual methods:
@@ -4209,6 +4707,10 @@ bool QCPAbstractPlottable1D<DataType>::sortKeyIsMainKey() const
   point-like. Most subclasses will want to reimplement this method again, to provide a more
   accurate hit test based on the true data visualization geometry.
 
+  If the data is sorted by its main key, the key range of \a rect is found by binary search and
+  the data points within its value range are looked up in the value summary of the data container
+  (see \ref QCPDataContainer::valueSpans), so large data sets don't need to be scanned linearly.
+
   \seebaseclassmethod
 */
 template <class DataType>
@@ -4232,6 +4734,13 @@ QCPDataSelection QCPAbstractPlottable1D<DataType>::selectTestRect(const QRectF &
   {
     begin = mDataContainer->findBegin(keyRange.lower, false);
     end = mDataContainer->findEnd(keyRange.upper, false);
+    // all data points in between are within keyRange, so only their values remain to be tested:
+    QVector<QCPDataRange> spans;
+    mDataContainer->valueSpans(begin, end, valueRange, spans);
+    for (int i=0; i<spans.size(); ++i)
+      result.addDataRange(spans.at(i), false);
+    result.simplify();
+    return result;
   }
   if (begin == end)
     return result;
@@ -4501,6 +5010,8 @@ protected:
   // non-virtual methods:
   bool stopsUseAlpha() const;
   void updateColorBuffer();
+  
+  friend class QCPColorMap;
 };
 Q_DECLARE_METATYPE(QCPColorGradient::ColorInterpolation)
 Q_DECLARE_METATYPE(QCPColorGradient::GradientPreset)
@@ -5186,6 +5697,8 @@ public:
   int scatterSkip() const { return mScatterSkip; }
   QCPGraph *channelFillGraph() const { return mChannelFillGraph.data(); }
   bool adaptiveSampling() const { return mAdaptiveSampling; }
+  double valueScale() const { return mValueScale; }
+  double valueOffset() const { return mValueOffset; }
   
   // setters:
   void setData(QSharedPointer<QCPGraphDataContainer> data);
@@ -5195,6 +5708,7 @@ public:
   void setScatterSkip(int skip);
   void setChannelFillGraph(QCPGraph *targetGraph);
   void setAdaptiveSampling(bool enabled);
+  void setValueTransform(double scale, double offset=0);
   
   // non-property methods:
   void addData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
@@ -5202,6 +5716,7 @@ public:
   
   // reimplemented virtual methods:
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const Q_DECL_OVERRIDE;
+  virtual QCPDataSelection selectTestRect(const QRectF &rect, bool onlySelectable) const Q_DECL_OVERRIDE;
   virtual QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth) const Q_DECL_OVERRIDE;
   virtual QCPRange getValueRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const Q_DECL_OVERRIDE;
   
@@ -5212,6 +5727,27 @@ protected:
   int mScatterSkip;
   QPointer<QCPGraph> mChannelFillGraph;
   bool mAdaptiveSampling;
+  double mValueScale, mValueOffset;
+  
+  // non-property members:
+  struct LineCache
+  {
+    bool valid;
+    QVector<QPointF> lines; // the lsLine pixel polyline of the visible data, see getCachedLines
+    QWeakPointer<QCPGraphDataContainer> data;
+    quint64 revision; // of data when lines were built
+    int begin, end; // storage positions (see QCPDataContainer::storageOffset) of the data in lines
+    int tailBegin; // storage position where the last, possibly incomplete pixel interval starts
+    int tailLines; // points in lines before that interval
+    double tailPreviousKey; // key of the data point before tailBegin, NaN if there is none
+    bool adaptive;
+    double valueScale, valueOffset;
+    QRect axisRect;
+    bool keyReversed, valueReversed;
+    double keySize, valueSize; // axis range sizes when lines were built
+    double keyLower, keyLowerPixel, valueLower, valueLowerPixel; // to translate lines when the axis ranges move
+  };
+  mutable LineCache mLineCache;
   
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
@@ -5228,9 +5764,18 @@ protected:
   
   // non-virtual methods:
   void getVisibleDataBounds(QCPGraphDataContainer::const_iterator &begin, QCPGraphDataContainer::const_iterator &end, const QCPDataRange &rangeRestriction) const;
+  QCPDataRange getClipDataRange(const QCPPainter *painter) const;
   void getLines(QVector<QPointF> *lines, const QCPDataRange &dataRange) const;
+  bool getCachedLines(QVector<QPointF> *lines, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end) const;
+  bool useAdaptiveLineSampling(const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end) const;
+  void getAdaptiveLineData(QVector<QCPGraphData> *lineData, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end, double lastIntervalEndKey,
+                           QCPGraphDataContainer::const_iterator *lastIntervalBegin, int *lastIntervalIndex) const;
   void getScatters(QVector<QPointF> *scatters, const QCPDataRange &dataRange) const;
+  bool hasValueTransform() const { return mValueScale != 1.0 || mValueOffset != 0.0; }
+  double transformedValue(double value) const { return value*mValueScale+mValueOffset; }
+  void applyValueTransform(QVector<QCPGraphData> *data) const;
   QVector<QPointF> dataToLines(const QVector<QCPGraphData> &data) const;
+  void coordsToPixels(const QCPGraphData *begin, const QCPGraphData *end, QPointF *pixels) const;
   QVector<QPointF> dataToStepLeftLines(const QVector<QCPGraphData> &data) const;
   QVector<QPointF> dataToStepRightLines(const QVector<QCPGraphData> &data) const;
   QVector<QPointF> dataToStepCenterLines(const QVector<QCPGraphData> &data) const;
@@ -5246,12 +5791,56 @@ protected:
   int findIndexBelowY(const QVector<QPointF> *data, double y) const;
   int findIndexAboveY(const QVector<QPointF> *data, double y) const;
   double pointDistance(const QPointF &pixelPoint, QCPGraphDataContainer::const_iterator &closestData) const;
+  QCPRange valueWindow(double valuePixel, double radius) const;
   
   friend class QCustomPlot;
   friend class QCPLegend;
 };
 Q_DECLARE_METATYPE(QCPGraph::LineStyle)
 
+#ifdef QCP_OPENGL_FBO
+class QCP_LIB_DECL QCPGlLineRenderer : protected QOpenGLFunctions
+{
+public:
+  explicit QCPGlLineRenderer(QOpenGLContext *context);
+  virtual ~QCPGlLineRenderer();
+  
+  // getters:
+  bool isValid() const { return mValid; }
+  
+  // non-property methods:
+  bool drawGraph(QCPPainter *painter, const QCPGraph *graph);
+  void releaseGraph(const QCPGraph *graph);
+  
+protected:
+  enum { VertexComponents = 3, UploadBlockSize = 65536 }; // a vertex is the key split into two floats and the value
+  enum { KeyHighAttribute, KeyLowAttribute, ValueAttribute };
+  struct GraphBuffer
+  {
+    QOpenGLBuffer vertices;
+    QWeakPointer<QCPGraphDataContainer> data; // the container mirrored in vertices
+    quint64 revision; // the container's revision when vertices were filled
+    int uploaded; // storage positions below this are in vertices
+    int capacity; // vertices that fit into the buffer
+    int lastNaN; // storage position of the last NaN value in vertices, -1 if there is none
+  };
+  
+  // non-property members:
+  QOpenGLContext *mContext;
+  QOpenGLShaderProgram mProgram;
+  QHash<const QCPGraph*, GraphBuffer*> mBuffers;
+  QVector<GLfloat> mStaging;
+  float mMaxLineWidth;
+  bool mValid;
+  
+  // non-virtual methods:
+  void makeCurrent();
+  bool canDraw(QCPPainter *painter, const QCPGraph *graph, double *lineWidth) const;
+  GraphBuffer *syncBuffer(const QCPGraph *graph);
+  void upload(GraphBuffer *buffer, const QCPGraphDataContainer &data, int from, int to);
+};
+#endif // QCP_OPENGL_FBO
+
 /* end of 'src/plottables/plottable-graph.h' */
 
 
@@ -5728,6 +6317,7 @@ protected:
   unsigned char *mAlpha;
   QCPRange mDataBounds;
   bool mDataModified;
+  QRect mModifiedCells; // key (x) and value (y) indices of the cells changed by single cell access since the last map image update
   
   bool createAlpha(bool initializeOpaque=true);
   
@@ -5797,6 +6387,21 @@ protected:
   QPixmap mLegendIcon;
   bool mMapImageInvalidated;
   
+  // colorization of a block of image lines, see colorizeLines:
+  enum { ParallelColorizeCells = 65536 }; // below this many cells, colorizing on several threads doesn't pay off
+  struct ColorizeTask
+  {
+    QCPColorGradient *gradient;
+    const double *data;
+    const unsigned char *alpha; // 0 if the map has no alpha
+    int lineStride, columnStride; // data index distance between consecutive lines and columns
+    QCPRange range;
+    bool logarithmic;
+    uchar *bits; // of the image
+    int bytesPerLine, lineCount;
+    int lineFrom, lineTo, columnFrom, columnTo;
+  };
+  
   // introduced virtual methods:
   virtual void updateMapImage();
   
@@ -5804,6 +6409,92 @@ protected:
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
   virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const Q_DECL_OVERRIDE;
   
+  // non-virtual methods:
+  static void colorizeLines(const ColorizeTask &task);
+  
+  friend class QCustomPlot;
+  friend class QCPLegend;
+};
+
+
+class QCP_LIB_DECL QCPWaterfall : public QCPAbstractPlottable
+{
+  Q_OBJECT
+  /// \cond INCLUDE_QPROPERTIES
+  Q_PROPERTY(QCPRange dataRange READ dataRange WRITE setDataRange NOTIFY dataRangeChanged)
+  Q_PROPERTY(QCPAxis::ScaleType dataScaleType READ dataScaleType WRITE setDataScaleType NOTIFY dataScaleTypeChanged)
+  Q_PROPERTY(QCPColorGradient gradient READ gradient WRITE setGradient NOTIFY gradientChanged)
+  Q_PROPERTY(bool interpolate READ interpolate WRITE setInterpolate)
+  Q_PROPERTY(QCPColorScale* colorScale READ colorScale WRITE setColorScale)
+  /// \endcond
+public:
+  explicit QCPWaterfall(QCPAxis *keyAxis, QCPAxis *valueAxis);
+  
+  // getters:
+  int columnCount() const { return mColumnCount; }
+  int rowCount() const { return mRowCount; }
+  QCPRange valueRange() const { return mValueRange; }
+  QCPRange dataRange() const { return mDataRange; }
+  QCPAxis::ScaleType dataScaleType() const { return mDataScaleType; }
+  bool interpolate() const { return mInterpolate; }
+  QCPColorGradient gradient() const { return mGradient; }
+  QCPColorScale *colorScale() const { return mColorScale.data(); }
+  
+  // setters:
+  void setSize(int columnCount, int rowCount);
+  void setValueRange(const QCPRange &valueRange);
+  Q_SLOT void setDataRange(const QCPRange &dataRange);
+  Q_SLOT void setDataScaleType(QCPAxis::ScaleType scaleType);
+  Q_SLOT void setGradient(const QCPColorGradient &gradient);
+  void setInterpolate(bool enabled);
+  void setColorScale(QCPColorScale *colorScale);
+  
+  // non-property methods:
+  int size() const { return mSize; }
+  bool isEmpty() const { return mSize == 0; }
+  void addColumn(double key, const QVector<double> &values);
+  void clear();
+  void rescaleDataRange();
+  
+  // reimplemented virtual methods:
+  virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const Q_DECL_OVERRIDE;
+  virtual QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth) const Q_DECL_OVERRIDE;
+  virtual QCPRange getValueRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const Q_DECL_OVERRIDE;
+  
+signals:
+  void dataRangeChanged(const QCPRange &newRange);
+  void dataScaleTypeChanged(QCPAxis::ScaleType scaleType);
+  void gradientChanged(const QCPColorGradient &newGradient);
+  
+protected:
+  // property members:
+  QCPRange mValueRange;
+  QCPRange mDataRange;
+  QCPAxis::ScaleType mDataScaleType;
+  QCPColorGradient mGradient;
+  bool mInterpolate;
+  QPointer<QCPColorScale> mColorScale;
+  
+  // non-property members:
+  int mColumnCount, mRowCount;
+  QVector<double> mData; // ring buffer of mColumnCount columns with mRowCount cells each
+  QVector<double> mKeys; // key of the column in each slot of mData
+  int mFirstColumn; // slot of the oldest column
+  int mSize; // columns currently held
+  QImage mImage; // one scan line per slot of mData, one pixel per row
+  int mUncolorizedColumns; // newest columns not yet colorized into mImage
+  bool mImageInvalidated;
+  
+  // reimplemented virtual methods:
+  virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
+  virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const Q_DECL_OVERRIDE;
+  
+  // non-virtual methods:
+  void updateImage();
+  void colorizeColumn(int slot);
+  double columnSpacing() const;
+  double rowSpacing() const { return mRowCount > 1 ? mValueRange.size()/(mRowCount-1) : mValueRange.size(); }
+  
   friend class QCustomPlot;
   friend class QCPLegend;
 };
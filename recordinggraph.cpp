@@ -0,0 +1,233 @@
+#include "recordinggraph.h"
+
+#include <algorithm>
+#include <limits>
+
+static bool SampleBefore(const SessionSample& sample, double timestamp)
+{
+    return sample.timestamp < timestamp;
+}
+
+static bool SampleAfter(double timestamp, const SessionSample& sample)
+{
+    return timestamp < sample.timestamp;
+}
+
+RecordingGraph::RecordingGraph(QCPAxis* keyAxis, QCPAxis* valueAxis, const SessionReader* reader, int channel)
+    : QCPAbstractPlottable(keyAxis, valueAxis)
+    , reader(reader)
+    , channel(channel)
+{
+    setSelectable(QCP::stNone);
+    setBrush(Qt::NoBrush);
+}
+
+double RecordingGraph::selectTest(const QPointF& pos, bool onlySelectable, QVariant* details) const
+{
+    Q_UNUSED(pos);
+    Q_UNUSED(onlySelectable);
+    Q_UNUSED(details);
+    return -1; // not selectable
+}
+
+QCPRange RecordingGraph::getKeyRange(bool& foundRange, QCP::SignDomain inSignDomain) const
+{
+    const QVector<int>& chunks = reader->ChannelChunks(channel);
+    foundRange = !chunks.isEmpty() && inSignDomain != QCP::sdNegative; // keys are seconds since the start of the session
+    if (!foundRange) {
+        return QCPRange();
+    }
+    return QCPRange(reader->Chunks()[chunks.first()].firstTime - reader->StartTime(),
+        reader->Chunks()[chunks.last()].lastTime - reader->StartTime());
+}
+
+QCPRange RecordingGraph::getValueRange(bool& foundRange, QCP::SignDomain inSignDomain, const QCPRange& inKeyRange) const
+{
+    int begin = 0;
+    int end = reader->ChannelChunks(channel).size();
+    if (inKeyRange != QCPRange()) {
+        VisibleChunks(inKeyRange.lower, inKeyRange.upper, &begin, &end);
+    }
+
+    /* the index holds the value range of every chunk, so this doesn't touch any sample */
+    double minValue = std::numeric_limits<double>::max();
+    double maxValue = -std::numeric_limits<double>::max();
+    for (int i = begin; i < end; i++) {
+        const SessionIndexEntry& chunk = reader->Chunks()[reader->ChannelChunks(channel)[i]];
+        minValue = qMin(minValue, chunk.minValue);
+        maxValue = qMax(maxValue, chunk.maxValue);
+    }
+    foundRange = begin < end;
+    if (foundRange && inSignDomain == QCP::sdPositive) {
+        foundRange = maxValue > 0;
+        minValue = minValue > 0 ? minValue : maxValue * 1e-3;
+    } else if (foundRange && inSignDomain == QCP::sdNegative) {
+        foundRange = minValue < 0;
+        maxValue = maxValue < 0 ? maxValue : minValue * 1e-3;
+    }
+    return foundRange ? QCPRange(minValue, maxValue) : QCPRange();
+}
+
+void RecordingGraph::draw(QCPPainter* painter)
+{
+    QCPAxis* keyAxis = mKeyAxis.data();
+    if (keyAxis == nullptr || mValueAxis.isNull() || !reader->IsOpen()) {
+        return;
+    }
+
+    const QCPRange range = keyAxis->range();
+    int begin, end;
+    VisibleChunks(range.lower, range.upper, &begin, &end);
+    if (begin >= end) {
+        return;
+    }
+
+    /* the raw samples are only read if there are fewer of them than pixel columns */
+    const double columns = qAbs(keyAxis->coordToPixel(range.upper) - keyAxis->coordToPixel(range.lower));
+    quint64 visibleSamples = 0;
+    for (int i = begin; i < end && visibleSamples <= columns * 2; i++) {
+        visibleSamples += reader->Chunks()[reader->ChannelChunks(channel)[i]].count;
+    }
+    lines.resize(0);
+    if (visibleSamples <= columns * 2) {
+        GetRawLines(range.lower, range.upper, begin, end);
+    } else {
+        GetColumnLines(range.lower, range.upper, begin, end);
+    }
+    if (lines.size() < 2) {
+        return;
+    }
+
+    applyDefaultAntialiasingHint(painter);
+    painter->setPen(mPen);
+    painter->setBrush(Qt::NoBrush);
+    painter->drawPolyline(lines.constData(), lines.size());
+}
+
+void RecordingGraph::drawLegendIcon(QCPPainter* painter, const QRectF& rect) const
+{
+    applyDefaultAntialiasingHint(painter);
+    painter->setPen(mPen);
+    painter->drawLine(QLineF(rect.left(), rect.top() + rect.height() / 2.0, rect.right() + 5, rect.top() + rect.height() / 2.0));
+}
+
+/* The chunks of a channel don't overlap in time, so both their first and last times are sorted */
+void RecordingGraph::VisibleChunks(double from, double to, int* begin, int* end) const
+{
+    const QVector<SessionIndexEntry>& all = reader->Chunks();
+    const QVector<int>& chunks = reader->ChannelChunks(channel);
+    const double first = from + reader->StartTime();
+    const double last = to + reader->StartTime();
+    *begin = int(std::partition_point(chunks.begin(), chunks.end(), [&](int i) { return all[i].lastTime < first; }) - chunks.begin());
+    *end = int(std::partition_point(chunks.begin() + *begin, chunks.end(), [&](int i) { return all[i].firstTime <= last; }) - chunks.begin());
+}
+
+void RecordingGraph::GetRawLines(double from, double to, int begin, int end)
+{
+    const QVector<SessionIndexEntry>& all = reader->Chunks();
+    const QVector<int>& chunks = reader->ChannelChunks(channel);
+    const double start = reader->StartTime();
+    const SessionSample* before = nullptr; // the samples next to the range keep the line running to the plot border
+    const SessionSample* after = nullptr;
+
+    if (begin > 0) {
+        const SessionIndexEntry& chunk = all[chunks[begin - 1]];
+        before = reader->Samples(chunk) + chunk.count - 1;
+    }
+    if (end < chunks.size()) {
+        after = reader->Samples(all[chunks[end]]);
+    }
+
+    for (int i = begin; i < end; i++) {
+        const SessionIndexEntry& chunk = all[chunks[i]];
+        const SessionSample* samples = reader->Samples(chunk);
+        const SessionSample* first = std::lower_bound(samples, samples + chunk.count, from + start, SampleBefore);
+        const SessionSample* last = std::upper_bound(first, samples + chunk.count, to + start, SampleAfter);
+        if (first > samples) {
+            before = first - 1;
+        }
+        if (last < samples + chunk.count) { // only the chunk holding the end of the range
+            after = last;
+        }
+        if (before != nullptr && first < last) {
+            lines.append(coordsToPixels(before->timestamp - start, before->value));
+            before = nullptr;
+        }
+        for (const SessionSample* sample = first; sample < last; sample++) {
+            lines.append(coordsToPixels(sample->timestamp - start, sample->value));
+        }
+    }
+    if (before != nullptr) { // nothing inside the range, connect the neighbours across it
+        lines.append(coordsToPixels(before->timestamp - start, before->value));
+    }
+    if (after != nullptr) {
+        lines.append(coordsToPixels(after->timestamp - start, after->value));
+    }
+}
+
+void RecordingGraph::GetColumnLines(double from, double to, int begin, int end)
+{
+    QCPAxis* keyAxis = mKeyAxis.data();
+    QCPAxis* valueAxis = mValueAxis.data();
+    const QVector<SessionIndexEntry>& all = reader->Chunks();
+    const QVector<int>& chunks = reader->ChannelChunks(channel);
+    const double start = reader->StartTime();
+    const double first = from + start;
+    const double last = to + start;
+
+    const double pixelFrom = qMin(keyAxis->coordToPixel(from), keyAxis->coordToPixel(to));
+    const int columns = int(qAbs(keyAxis->coordToPixel(to) - keyAxis->coordToPixel(from))) + 1;
+    columnMin.fill(std::numeric_limits<double>::max(), columns);
+    columnMax.fill(-std::numeric_limits<double>::max(), columns);
+    auto column = [&](double timestamp) { return qBound(0, int(keyAxis->coordToPixel(timestamp - start) - pixelFrom), columns - 1); };
+
+    for (int i = begin; i < end; i++) {
+        const SessionIndexEntry& chunk = all[chunks[i]];
+        if (chunk.firstTime >= first && chunk.lastTime <= last && column(chunk.firstTime) == column(chunk.lastTime)) {
+            MergeColumn(column(chunk.firstTime), chunk.minValue, chunk.maxValue); // the index is enough
+            continue;
+        }
+
+        const SessionSample* samples = reader->Samples(chunk);
+        const SessionSummary* summaries = reader->Summaries(chunk);
+        const int count = int(chunk.count);
+        for (int block = 0; block * SESSION_SUMMARY_BLOCK < count; block++) {
+            const int blockBegin = block * SESSION_SUMMARY_BLOCK;
+            const int blockEnd = qMin(blockBegin + SESSION_SUMMARY_BLOCK, count);
+            const double blockFirst = samples[blockBegin].timestamp;
+            const double blockLast = samples[blockEnd - 1].timestamp;
+            if (blockLast < first || blockFirst > last) {
+                continue;
+            }
+            if (blockFirst >= first && blockLast <= last && column(blockFirst) == column(blockLast)) {
+                MergeColumn(column(blockFirst), summaries[block].minValue, summaries[block].maxValue);
+                continue;
+            }
+            for (int s = blockBegin; s < blockEnd; s++) { // block spans a column border
+                if (samples[s].timestamp >= first && samples[s].timestamp <= last) {
+                    MergeColumn(column(samples[s].timestamp), samples[s].value, samples[s].value);
+                }
+            }
+        }
+    }
+
+    const bool horizontal = keyAxis->orientation() == Qt::Horizontal;
+    for (int c = 0; c < columns; c++) {
+        if (columnMin[c] > columnMax[c]) {
+            continue; // no samples in this column
+        }
+        const double key = pixelFrom + c;
+        const double minPixel = valueAxis->coordToPixel(columnMin[c]);
+        const double maxPixel = valueAxis->coordToPixel(columnMax[c]);
+        lines.append(horizontal ? QPointF(key, minPixel) : QPointF(minPixel, key));
+        if (columnMax[c] > columnMin[c]) {
+            lines.append(horizontal ? QPointF(key, maxPixel) : QPointF(maxPixel, key));
+        }
+    }
+}
+
+void RecordingGraph::MergeColumn(int column, double minValue, double maxValue)
+{
+    columnMin[column] = qMin(columnMin[column], minValue);
+    columnMax[column] = qMax(columnMax[column], maxValue);
+}
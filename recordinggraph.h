@@ -0,0 +1,47 @@
+#ifndef RECORDINGGRAPH_H
+#define RECORDINGGRAPH_H
+
+#include "qcustomplot.h"
+#include "sessionreader.h"
+
+/*
+ * Plots one channel of a recorded session straight from the mapped file, without copying it
+ * into a QCPGraph container. Zoomed out, every pixel column is drawn from the min/max of the
+ * chunk index and the per-block summaries stored in the file, so only the chunks at the column
+ * borders are read. Zoomed in far enough that there are fewer samples than pixels, the raw
+ * samples of the visible window are drawn. Memory use depends on the plot width, not on the
+ * length of the recording.
+ */
+class RecordingGraph : public QCPAbstractPlottable {
+    Q_OBJECT
+
+public:
+    RecordingGraph(QCPAxis* keyAxis, QCPAxis* valueAxis, const SessionReader* reader, int channel);
+
+    int Channel() const { return channel; }
+
+    // reimplemented virtual methods:
+    double selectTest(const QPointF& pos, bool onlySelectable, QVariant* details = 0) const override;
+    QCPRange getKeyRange(bool& foundRange, QCP::SignDomain inSignDomain = QCP::sdBoth) const override;
+    QCPRange getValueRange(bool& foundRange, QCP::SignDomain inSignDomain = QCP::sdBoth, const QCPRange& inKeyRange = QCPRange()) const override;
+
+protected:
+    void draw(QCPPainter* painter) override;
+    void drawLegendIcon(QCPPainter* painter, const QRectF& rect) const override;
+
+private:
+    const SessionReader* reader;
+    int channel;
+
+    // reused between replots
+    QVector<QPointF> lines;
+    QVector<double> columnMin;
+    QVector<double> columnMax;
+
+    void VisibleChunks(double from, double to, int* begin, int* end) const; // indexes into reader->ChannelChunks(channel)
+    void GetRawLines(double from, double to, int begin, int end);
+    void GetColumnLines(double from, double to, int begin, int end);
+    void MergeColumn(int column, double minValue, double maxValue);
+};
+
+#endif // RECORDINGGRAPH_H
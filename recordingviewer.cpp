@@ -0,0 +1,54 @@
+#include "recordingviewer.h"
+#include "recordinggraph.h"
+
+#include <QFileInfo>
+#include <QVBoxLayout>
+
+RecordingViewer::RecordingViewer(const ChannelRegistry& channelRegistry, QWidget* parent)
+    : QWidget(parent, Qt::Window)
+    , channelRegistry(channelRegistry)
+{
+    setAttribute(Qt::WA_DeleteOnClose);
+    resize(1000, 500);
+
+    plot = new QCustomPlot(this);
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(plot);
+
+    QSharedPointer<QCPAxisTickerTime> timeTicker(new QCPAxisTickerTime);
+    timeTicker->setTimeFormat("%h:%m:%s");
+    plot->xAxis->setTicker(timeTicker);
+    plot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+    plot->axisRect()->setRangeZoom(Qt::Horizontal); // wheel zooms the time, drag pans both
+    plot->legend->setVisible(true);
+    plot->axisRect()->insetLayout()->setInsetAlignment(0, Qt::AlignLeft | Qt::AlignTop);
+}
+
+RecordingViewer::~RecordingViewer()
+{
+    delete plot; // before the reader unmaps the file the graphs point into
+}
+
+bool RecordingViewer::Open(const QString& fileName)
+{
+    if (!reader.Open(fileName)) {
+        return false;
+    }
+    setWindowTitle(QFileInfo(fileName).fileName());
+
+    for (int channel : reader.Channels()) {
+        RecordingGraph* graph = new RecordingGraph(plot->xAxis, plot->yAxis, &reader, channel);
+        if (channel < channelRegistry.Size() && channelRegistry.Info(channel).IsValid()) {
+            const ChannelInfo& info = channelRegistry.Info(channel);
+            graph->setName(info.unit.isEmpty() ? info.name : QString("%1 [%2]").arg(info.name, info.unit));
+            graph->setPen(QPen(info.color));
+        } else {
+            graph->setName(QString("Channel %1").arg(channel));
+            graph->setPen(QPen(QColor::fromHsv((channel * 47) % 360, 255, 200)));
+        }
+    }
+    plot->rescaleAxes();
+    plot->replot();
+    return true;
+}
@@ -0,0 +1,29 @@
+#ifndef RECORDINGVIEWER_H
+#define RECORDINGVIEWER_H
+
+#include <QWidget>
+
+#include "channelregistry.h"
+#include "qcustomplot.h"
+#include "sessionreader.h"
+
+/*
+ * Window that browses a whole recorded session. Every recorded channel is a RecordingGraph
+ * on the mapped file, so sessions far larger than the memory can be panned and zoomed.
+ */
+class RecordingViewer : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit RecordingViewer(const ChannelRegistry& channelRegistry, QWidget* parent = nullptr);
+    ~RecordingViewer();
+
+    bool Open(const QString& fileName); // false if the file isn't a readable session
+
+private:
+    const ChannelRegistry& channelRegistry;
+    SessionReader reader; // must outlive the graphs, see ~RecordingViewer
+    QCustomPlot* plot;
+};
+
+#endif // RECORDINGVIEWER_H
@@ -0,0 +1,28 @@
+#ifndef SAMPLE_H
+#define SAMPLE_H
+
+#include <QMetaType>
+#include <QSharedPointer>
+#include <QVector>
+
+/* One decoded value of one channel, as handed from the serial thread to the gui */
+struct Sample {
+    double timestamp; // seconds
+    double value;
+    int channel;
+};
+
+/* All samples decoded in one read, grouped per channel as contiguous key/value arrays */
+struct SampleBatch {
+    struct Channel {
+        int channel;
+        QVector<double> keys; // timestamps, seconds
+        QVector<double> values;
+    };
+    QVector<Channel> channels;
+};
+
+typedef QSharedPointer<const SampleBatch> SampleBatchPtr; // immutable once emitted
+Q_DECLARE_METATYPE(SampleBatchPtr)
+
+#endif // SAMPLE_H
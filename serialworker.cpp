@@ -1,9 +1,54 @@
 #include "serialworker.h"
 #include "config.h"
+#include "hostclock.h"
 
-#include <QTime>
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+static std::array<quint16, 256> MakeCrc16Table()
+{
+    std::array<quint16, 256> table;
+    for (int i = 0; i < 256; i++) {
+        quint16 crc = i << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+/* CRC16-CCITT (poly 0x1021, init 0xFFFF), table driven */
+static quint16 Crc16(const uchar* data, int len)
+{
+    static const std::array<quint16, 256> table = MakeCrc16Table(); // static initialization is thread safe, every source thread calls this
+
+    quint16 crc = 0xFFFF;
+    for (int i = 0; i < len; i++) {
+        crc = (crc << 8) ^ table[((crc >> 8) ^ data[i]) & 0xFF];
+    }
+    return crc;
+}
+
+static int FrameSampleSize(uchar format)
+{
+    switch (format & ~FRAME_FLAG_TIMESTAMP) {
+    case FRAME_FMT_FLOAT32:
+        return 4;
+    case FRAME_FMT_INT16:
+        return 2;
+    case FRAME_FMT_TEXT:
+        return 1;
+    default:
+        return 0; // unknown format
+    }
+}
 
 SerialWorker::SerialWorker(QObject* parent)
+    : sampleRing(SAMPLE_RING_CAPACITY)
+    , lineParser(&stats, MAX_LINE_LENGTH)
+    , clockSync(DEVICE_TICKS_PER_SECOND, CLOCK_SYNC_WINDOW)
 {
     this->setParent(parent);
     serialPort = nullptr;
@@ -21,10 +66,12 @@ void SerialWorker::CloseConnection()
         delete (serialPort);
         serialPort = nullptr;
     }
+    frameBuffer.clear();
+    lineParser.Reset();
     emit portClosed();
 }
 
-void SerialWorker::PortConnect(QString portName, int baudRate, int dataBitsIndex, int parityIndex, int stopBitsIndex)
+void SerialWorker::PortConnect(QString portName, int baudRate, int dataBitsIndex, int parityIndex, int stopBitsIndex, bool binaryFrames)
 {
 
     QSerialPortInfo portInfo(portName);
@@ -75,6 +122,21 @@ void SerialWorker::PortConnect(QString portName, int baudRate, int dataBitsIndex
         serialPort->setParity(parity);
         serialPort->setDataBits(dataBits);
         serialPort->setStopBits(stopBits);
+
+        /* Tell the device which format to stream; stale bytes of the old format are dropped */
+        this->binaryFrames = binaryFrames;
+        frameBuffer.clear();
+        lineParser.Reset();
+        clockSync.Reset();
+        std::fill(std::begin(lastFrameTime), std::end(lastFrameTime), 0.0); // don't spread the first frames over the time disconnected
+        serialPort->clear(QSerialPort::Input);
+        QByteArray mode;
+        mode.append(char(binaryFrames ? CUTE_BINARY_FRAMES_ON : CUTE_BINARY_FRAMES_OFF));
+        mode.append('\n');
+        mode.append(char(CUTE_GET_CHANNEL_INFO)); // ask the device to describe its channels
+        mode.append('\n');
+        serialPort->write(mode);
+
         emit portOpenOK();
     } else {
         qDebug() << serialPort->errorString();
@@ -90,16 +152,42 @@ void SerialWorker::PortDisconnect()
 
 void SerialWorker::PortReadData()
 {
+    qint64 available = serialPort->bytesAvailable();
+    if (available <= 0) {
+        return;
+    }
 
-    while (serialPort->canReadLine()) {
-        char buf[1024];
-        serialPort->readLine(buf, sizeof(buf));
+    if (binaryFrames) {
+        int kept = frameBuffer.size();
+        frameBuffer.resize(kept + int(available));
+        qint64 read = serialPort->read(frameBuffer.data() + kept, available);
+        frameBuffer.resize(kept + int(qMax(read, qint64(0))));
+        if (recorder != nullptr && read > 0) {
+            recorder->RecordRaw(channelBase / CHANNELS_PER_SOURCE, frameBuffer.constData() + kept, int(read), HostClock::Seconds());
+        }
+        ProcessFrames();
+    } else {
+        if (readBuffer.size() < available) {
+            readBuffer.resize(int(available));
+        }
+        qint64 read = serialPort->read(readBuffer.data(), available);
+        if (recorder != nullptr && read > 0) {
+            recorder->RecordRaw(channelBase / CHANNELS_PER_SOURCE, readBuffer.constData(), int(read), HostClock::Seconds());
+        }
+        if (read > 0) {
+            lineParser.Feed(readBuffer.constData(), int(read), [this](const char* begin, const char* end) {
+                ProcessDataLine(begin, end);
+            });
+        }
+    }
 
-        ProcessDataLine(buf);
+    FlushBatch();
+    if (recorder != nullptr) {
+        recorder->FlushStale(channelBase / CHANNELS_PER_SOURCE);
     }
 }
 
-void LogRemote(char* line)
+void LogRemote(const char* line)
 {
     uint8_t target = line[0];
 
@@ -137,33 +225,209 @@ void LogRemote(char* line)
     }
 }
 
-void SerialWorker::ProcessDataLine(char* line)
+void SerialWorker::PushSample(int channel, double value, double timestamp)
 {
-    //Time in case we need to timestamp the received data
-    static QTime time(QTime::currentTime());
-    double curTime = time.elapsed() / 1000.0; // time elapsed since start, in seconds
+    Sample sample;
+    sample.channel = channelBase + channel;
+    sample.value = value;
+    sample.timestamp = timestamp;
+    if (recorder != nullptr) {
+        recorder->RecordSample(channelBase / CHANNELS_PER_SOURCE, sample); // returns right away unless recording
+    }
+    if (!batchDelivery) {
+        sampleRing.Push(sample); // if the gui falls behind the sample is dropped and counted by the ring
+        return;
+    }
 
-    uint8_t target = line[0];
+    if (pendingBatch.isNull()) {
+        pendingBatch.reset(new SampleBatch);
+        std::fill(batchSlot, batchSlot + 256, -1);
+    }
+    int& slot = batchSlot[channel & 0xFF];
+    if (slot < 0) {
+        slot = pendingBatch->channels.size();
+        pendingBatch->channels.append(SampleBatch::Channel());
+        pendingBatch->channels.last().channel = channelBase + channel;
+    }
+    SampleBatch::Channel& block = pendingBatch->channels[slot];
+    block.keys.append(timestamp);
+    block.values.append(value);
+}
 
-    //qDebug() << "Target: " << target << " Received: " << line;
+void SerialWorker::FlushBatch()
+{
+    if (pendingBatch.isNull()) {
+        return;
+    }
+    emit ForwardSampleBatch(pendingBatch);
+    pendingBatch.reset(); // the emitted batch is never touched again
+}
 
-    if (target != ARD_LOG) {
-        double value = std::atof(line + 1);
+void SerialWorker::ProcessFrames()
+{
+    const uchar* buf = reinterpret_cast<const uchar*>(frameBuffer.constData());
+    const int size = frameBuffer.size();
+    qint64 hostNs = HostClock::Nanoseconds();
+    int pos = 0;
 
-        if (target >= 100 && target <= 120) { // from the remote; just print end return
-            LogRemote(line);
-            return;
+    while (size - pos >= FRAME_HEADER_SIZE) {
+        if (buf[pos] != FRAME_SYNC) { // resync: skip to the next sync byte
+            pos++;
+            continue;
+        }
+
+        int sampleSize = FrameSampleSize(buf[pos + 2]);
+        if (sampleSize == 0) {
+            pos++;
+            continue;
+        }
+
+        int headerSize = FRAME_HEADER_SIZE + ((buf[pos + 2] & FRAME_FLAG_TIMESTAMP) ? FRAME_TIMESTAMP_SIZE : 0);
+        int frameSize = headerSize + buf[pos + 3] * sampleSize + FRAME_CRC_SIZE;
+        if (size - pos < frameSize) {
+            break; // wait for the rest of the frame
+        }
+
+        const uchar* crcPos = buf + pos + frameSize - FRAME_CRC_SIZE;
+        quint16 crc = crcPos[0] | (crcPos[1] << 8);
+        if (Crc16(buf + pos + 1, frameSize - FRAME_CRC_SIZE - 1) != crc) {
+            Count(stats.malformed);
+            pos++; // corrupted, or a payload byte that looked like sync
+            continue;
         }
-        if (value < -255 || value > 255) { // is this a glitch?
-            qDebug() << "Discarding Target: " << target << " Value: " << value << " Meaning: " << QString::number(value);
-            qDebug() << "Was received as: " << line << endl;
+
+        DecodeFrame(buf + pos, hostNs);
+        pos += frameSize;
+    }
+
+    frameBuffer.remove(0, pos);
+}
+
+void SerialWorker::DecodeFrame(const uchar* frame, qint64 hostNs)
+{
+    uchar channel = frame[1];
+    uchar format = frame[2] & ~FRAME_FLAG_TIMESTAMP;
+    bool timestamped = frame[2] & FRAME_FLAG_TIMESTAMP;
+    int count = frame[3];
+    const uchar* payload = frame + FRAME_HEADER_SIZE;
+
+    double firstTime = 0, step = 0;
+    double curTime = hostNs / 1e9;
+    if (timestamped) {
+        quint32 rawTicks = payload[0] | (payload[1] << 8) | (payload[2] << 16) | (quint32(payload[3]) << 24);
+        quint16 tickStep = payload[4] | (payload[5] << 8);
+        payload += FRAME_TIMESTAMP_SIZE;
+
+        qint64 ticks = clockSync.Unwrap(rawTicks, hostNs);
+        // the newest sample is the one closest to its arrival; a text frame's count is bytes, not samples
+        qint64 lastTicks = format == FRAME_FMT_TEXT ? ticks : ticks + qint64(tickStep) * qMax(count - 1, 0);
+        clockSync.AddPair(lastTicks, hostNs);
+        clockDriftPpm.store(clockSync.DriftPpm(), std::memory_order_relaxed);
+
+        firstTime = clockSync.ToHostSeconds(ticks);
+        step = clockSync.ToHostSeconds(ticks + tickStep) - firstTime;
+    }
+
+    if (format == FRAME_FMT_TEXT) {
+        QByteArray text(reinterpret_cast<const char*>(payload), count);
+        ChannelInfo info;
+        if (channel == ARD_CHANNEL_INFO && ChannelRegistry::ParseAnnouncement(text, channelBase, &info)) {
+            emit channelAnnounced(info);
         } else {
-            emit ForwardReceivedDataDouble(target, value, curTime);
+            qDebug() << "Received" << text;
         }
+        return;
+    }
+    if (count == 0) {
+        return;
+    }
 
-    } else {
-        qDebug() << "Received" << line + 1;
+    if (!timestamped) {
+        /* The frame only carries the receive time; spread its samples evenly since the channel's last frame */
+        double lastTime = lastFrameTime[channel];
+        if (lastTime <= 0 || lastTime >= curTime) {
+            lastTime = curTime;
+        }
+        step = (curTime - lastTime) / count;
+        firstTime = curTime - (count - 1) * step;
+        lastFrameTime[channel] = curTime;
+    }
+
+    for (int i = 0; i < count; i++) {
+        double value;
+        if (format == FRAME_FMT_FLOAT32) {
+            quint32 bits = payload[0] | (payload[1] << 8) | (payload[2] << 16) | (quint32(payload[3]) << 24);
+            float f;
+            std::memcpy(&f, &bits, sizeof(f));
+            value = f;
+            payload += 4;
+        } else {
+            value = qint16(payload[0] | (payload[1] << 8));
+            payload += 2;
+        }
+        PushSample(channel, value, firstTime + i * step);
     }
+    Count(stats.samples, count);
+}
+
+void SerialWorker::ProcessDataLine(const char* begin, const char* end)
+{
+    qint64 hostNs = HostClock::Nanoseconds();
+
+    if (begin == end) {
+        Count(stats.malformed);
+        return;
+    }
+    uint8_t target = begin[0];
+
+    if (target == ARD_LOG) {
+        qDebug() << "Received" << QByteArray(begin + 1, int(end - begin - 1));
+        return;
+    }
+    if (target == ARD_CHANNEL_INFO) {
+        ChannelInfo info;
+        if (ChannelRegistry::ParseAnnouncement(QByteArray(begin + 1, int(end - begin - 1)), channelBase, &info)) {
+            emit channelAnnounced(info);
+        } else {
+            Count(stats.malformed);
+        }
+        return;
+    }
+    if (target >= 100 && target <= 120) { // from the remote; just print end return
+        LogRemote(QByteArray(begin, int(end - begin)).constData());
+        return;
+    }
+
+    double value;
+    const char* next;
+    if (!LineParser::ParseDouble(begin + 1, end, &value, &next)) {
+        Count(stats.malformed);
+        return;
+    }
+
+    double timestamp = hostNs / 1e9;
+    if (next < end && *next == LINE_TIMESTAMP_MARK) { // "<cmd><value>@<device ticks>"
+        double rawTicks;
+        if (!LineParser::ParseDouble(next + 1, end, &rawTicks, &next) || rawTicks < 0 || rawTicks > 4294967295.0) {
+            Count(stats.malformed);
+            return;
+        }
+        qint64 ticks = clockSync.Unwrap(quint32(rawTicks), hostNs);
+        clockSync.AddPair(ticks, hostNs);
+        clockDriftPpm.store(clockSync.DriftPpm(), std::memory_order_relaxed);
+        timestamp = clockSync.ToHostSeconds(ticks);
+    }
+    if (!LineParser::IsBlank(next, end)) {
+        Count(stats.malformed);
+        return;
+    }
+    if (value < -255 || value > 255) { // is this a glitch?
+        Count(stats.discarded);
+        return;
+    }
+
+    PushSample(target, value, timestamp);
+    Count(stats.samples);
 }
 
 void SerialWorker::PortSendData(const QByteArray data)
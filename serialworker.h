@@ -5,6 +5,14 @@
 #include <QSerialPort>
 #include <QSerialPortInfo>
 
+#include "channelregistry.h"
+#include "clocksync.h"
+#include "lineparser.h"
+#include "linkstats.h"
+#include "sample.h"
+#include "sessionrecorder.h"
+#include "spscring.h"
+
 class SerialWorker : public QObject {
     Q_OBJECT
 
@@ -12,25 +20,51 @@ public:
     explicit SerialWorker(QObject* parent = nullptr);
     ~SerialWorker();
 
+    SpscRing<Sample>* SampleRing() { return &sampleRing; } // drained by the gui thread
+    void SetBatchDelivery(bool enable) { batchDelivery = enable; } // call before moving to the worker thread
+    void SetChannelBase(int base) { channelBase = base; } // namespace of this source, call before moving to the worker thread
+    void SetRecorder(SessionRecorder* recorder) { this->recorder = recorder; } // call before moving to the worker thread
+    const LinkStats& Stats() const { return stats; } // safe to read from any thread
+    double ClockDriftPpm() const { return clockDriftPpm.load(std::memory_order_relaxed); }
+
 public slots:
-    void PortConnect(QString portName, int baudRate, int dataBitsIndex, int parityIndex, int stopBitsIndex);
+    void PortConnect(QString portName, int baudRate, int dataBitsIndex, int parityIndex, int stopBitsIndex, bool binaryFrames);
     void PortDisconnect();
     void PortReadData();
     void PortSendData(const QByteArray data);
 signals:
-    void ForwardReceivedDataDouble(char cmd, double value, double timestamp);
+    void ForwardSampleBatch(SampleBatchPtr batch); // batch delivery mode only
+    void channelAnnounced(ChannelInfo info);
     void portOpenOK();
     void portOpenFail();
     void portClosed();
 
 private:
-    QHash<int, QVector<double> > ReceivedData;
-    QHash<int, QVector<double> > ReceivedDataTimestamps;
+    SpscRing<Sample> sampleRing;
+    LinkStats stats;
+    std::atomic<double> clockDriftPpm { 0 }; // published copy of clockSync.DriftPpm() for the gui
+
+    int channelBase = 0; // added to every device channel id
+    SessionRecorder* recorder = nullptr; // gets every sample while it is recording
+    bool batchDelivery = false;
+    QSharedPointer<SampleBatch> pendingBatch; // filled during one PortReadData call
+    int batchSlot[256]; // channel -> index into pendingBatch->channels, -1 if not present yet
 
     QSerialPort* serialPort;
     void CloseConnection();
 
-    void ProcessDataLine(char* line);
+    bool binaryFrames = false; // negotiated at PortConnect
+    QByteArray readBuffer; // reused for every read of the text protocol
+    LineParser lineParser;
+    QByteArray frameBuffer; // holds a partially received binary frame between reads
+    double lastFrameTime[256] = {}; // per channel, used to spread the samples of a frame in time
+    ClockSync clockSync; // maps device timestamps to HostClock
+
+    void PushSample(int channel, double value, double timestamp);
+    void FlushBatch();
+    void ProcessDataLine(const char* begin, const char* end);
+    void ProcessFrames();
+    void DecodeFrame(const uchar* frame, qint64 hostNs);
 };
 
 #endif // SERIALWORKHER_H
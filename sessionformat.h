@@ -0,0 +1,97 @@
+#ifndef SESSIONFORMAT_H
+#define SESSIONFORMAT_H
+
+#include <QtGlobal>
+
+/*
+ * On-disk layout of a recorded session, see SessionRecorder. The structs are written exactly as
+ * they are laid out in memory (little endian, no padding), so a reader can map the file and use
+ * them in place.
+ *
+ * [SessionFileHeader][chunk][chunk]...[SessionFileTrailer]
+ *
+ * Every chunk is a SessionChunkHeader followed by payloadSize bytes:
+ *  SESSION_CHUNK_SAMPLES  count SessionSample of one channel in ascending time, followed by
+ *                         ceil(count / SESSION_SUMMARY_BLOCK) SessionSummary, the value range of
+ *                         each block of SESSION_SUMMARY_BLOCK samples
+ *  SESSION_CHUNK_RAW      count bytes as read from the serial port of one source, zero padded to a
+ *                         multiple of 8 so every chunk header is 8 byte aligned
+ *  SESSION_CHUNK_INDEX    count SessionIndexEntry, one per chunk written since the previous index
+ *
+ * The file is append only and every chunk is flushed when written, so after a crash everything up
+ * to the last complete chunk is readable. The trailer is only written when recording stops cleanly;
+ * without it a reader has to walk the chunk headers from the start.
+ */
+
+#define SESSION_MAGIC "ARDPLOT\x01" // 8 bytes, SessionFileHeader::magic
+#define SESSION_VERSION 1
+#define SESSION_CHUNK_MAGIC 0x4B4E4843 // "CHNK"
+#define SESSION_TRAILER_MAGIC 0x444E4553 // "SEND"
+
+#define SESSION_CHUNK_SAMPLES 1
+#define SESSION_CHUNK_RAW 2
+#define SESSION_CHUNK_INDEX 3
+
+#define SESSION_SUMMARY_BLOCK 64 // samples per SessionSummary entry
+
+struct SessionFileHeader {
+    char magic[8];
+    quint32 version;
+    quint32 headerSize; // sizeof(SessionFileHeader), the first chunk starts here
+    double startTime; // HostClock seconds when recording started, sample timestamps use the same clock
+    qint64 startDateMs; // wall clock at startTime, ms since the epoch (UTC)
+};
+
+struct SessionChunkHeader {
+    quint32 magic; // SESSION_CHUNK_MAGIC
+    quint16 type; // SESSION_CHUNK_*
+    quint16 source; // serial source that produced the data
+    qint32 channel; // channel id of a sample chunk, -1 otherwise
+    quint32 count; // samples, bytes or index entries
+    quint32 payloadSize; // bytes following this header
+    quint32 reserved;
+    double firstTime; // time range covered by the chunk, HostClock seconds
+    double lastTime;
+    double minValue; // value range of a sample chunk
+    double maxValue;
+    quint64 previousIndex; // index chunk only: file offset of the previous index chunk, 0 if none
+};
+
+struct SessionSample {
+    double timestamp; // HostClock seconds
+    double value;
+};
+
+struct SessionSummary {
+    double minValue;
+    double maxValue;
+};
+
+/* Describes one chunk, so a reader can find the chunks of a channel and time without touching them */
+struct SessionIndexEntry {
+    quint64 offset; // file offset of the chunk's SessionChunkHeader
+    quint16 type;
+    quint16 source;
+    qint32 channel;
+    quint32 count;
+    quint32 reserved;
+    double firstTime;
+    double lastTime;
+    double minValue;
+    double maxValue;
+};
+
+struct SessionFileTrailer {
+    quint64 lastIndex; // file offset of the last index chunk, follow previousIndex for the others
+    quint32 magic; // SESSION_TRAILER_MAGIC
+    quint32 reserved;
+};
+
+static_assert(sizeof(SessionFileHeader) == 32, "SessionFileHeader must match the file layout");
+static_assert(sizeof(SessionChunkHeader) == 64, "SessionChunkHeader must match the file layout");
+static_assert(sizeof(SessionSample) == 16, "SessionSample must match the file layout");
+static_assert(sizeof(SessionSummary) == 16, "SessionSummary must match the file layout");
+static_assert(sizeof(SessionIndexEntry) == 56, "SessionIndexEntry must match the file layout");
+static_assert(sizeof(SessionFileTrailer) == 16, "SessionFileTrailer must match the file layout");
+
+#endif // SESSIONFORMAT_H
@@ -0,0 +1,173 @@
+#include "sessionreader.h"
+
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+static bool ChunkStartsEarlier(const SessionIndexEntry& a, const SessionIndexEntry& b)
+{
+    return a.firstTime < b.firstTime || (a.firstTime == b.firstTime && a.offset < b.offset);
+}
+
+bool SessionReader::Open(const QString& fileName)
+{
+    Close();
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "Can't open session" << fileName << file.errorString();
+        return false;
+    }
+    size = file.size();
+    if (size < qint64(sizeof(SessionFileHeader))) {
+        qDebug() << fileName << "is not a session file";
+        Close();
+        return false;
+    }
+    data = file.map(0, size);
+    if (data == nullptr) {
+        qDebug() << "Can't map session" << fileName << file.errorString();
+        Close();
+        return false;
+    }
+    if (std::memcmp(Header().magic, SESSION_MAGIC, sizeof(Header().magic)) != 0 || Header().version != SESSION_VERSION
+        || Header().headerSize < sizeof(SessionFileHeader) || Header().headerSize > quint64(size)) {
+        qDebug() << fileName << "is not a session file of version" << SESSION_VERSION;
+        Close();
+        return false;
+    }
+
+    QVector<SessionIndexEntry> entries;
+    SessionFileTrailer trailer;
+    std::memcpy(&trailer, data + size - sizeof(trailer), sizeof(trailer));
+    if (trailer.magic != SESSION_TRAILER_MAGIC || !ReadIndexChain(trailer.lastIndex, &entries)) {
+        entries.resize(0);
+        ScanChunks(&entries); // not stopped cleanly
+    }
+
+    endTime = StartTime();
+    for (const SessionIndexEntry& entry : entries) {
+        if (entry.type != SESSION_CHUNK_SAMPLES || entry.count == 0) {
+            continue;
+        }
+        chunks.append(entry);
+        endTime = qMax(endTime, entry.lastTime);
+    }
+    std::sort(chunks.begin(), chunks.end(), ChunkStartsEarlier);
+
+    for (int i = 0; i < chunks.size(); i++) {
+        const int channel = chunks[i].channel;
+        if (channel < 0) {
+            continue;
+        }
+        if (channel >= channelChunks.size()) {
+            channelChunks.resize(channel + 1);
+        }
+        channelChunks[channel].append(i);
+    }
+    return true;
+}
+
+void SessionReader::Close()
+{
+    if (data != nullptr) {
+        file.unmap(const_cast<uchar*>(data));
+        data = nullptr;
+    }
+    file.close();
+    size = 0;
+    endTime = 0;
+    chunks.clear();
+    channelChunks.clear();
+}
+
+const QVector<int>& SessionReader::ChannelChunks(int channel) const
+{
+    static const QVector<int> none;
+    return (channel >= 0 && channel < channelChunks.size()) ? channelChunks[channel] : none;
+}
+
+QVector<int> SessionReader::Channels() const
+{
+    QVector<int> channels;
+    for (int channel = 0; channel < channelChunks.size(); channel++) {
+        if (!channelChunks[channel].isEmpty()) {
+            channels.append(channel);
+        }
+    }
+    return channels;
+}
+
+const SessionSample* SessionReader::Samples(const SessionIndexEntry& chunk) const
+{
+    return reinterpret_cast<const SessionSample*>(data + chunk.offset + sizeof(SessionChunkHeader));
+}
+
+const SessionSummary* SessionReader::Summaries(const SessionIndexEntry& chunk) const
+{
+    return reinterpret_cast<const SessionSummary*>(data + chunk.offset + sizeof(SessionChunkHeader) + chunk.count * sizeof(SessionSample));
+}
+
+/* Follows the index chunks backwards from the trailer; false if any link is broken */
+bool SessionReader::ReadIndexChain(quint64 lastIndex, QVector<SessionIndexEntry>* entries) const
+{
+    quint64 offset = lastIndex;
+    while (offset != 0) {
+        if (!IsValidChunk(offset)) {
+            return false;
+        }
+        const SessionChunkHeader* header = reinterpret_cast<const SessionChunkHeader*>(data + offset);
+        if (header->type != SESSION_CHUNK_INDEX || header->payloadSize != header->count * sizeof(SessionIndexEntry)
+            || header->previousIndex >= offset) {
+            return false;
+        }
+        const SessionIndexEntry* indexEntries = reinterpret_cast<const SessionIndexEntry*>(header + 1);
+        for (quint32 i = 0; i < header->count; i++) {
+            if (!IsValidChunk(indexEntries[i].offset)) {
+                return false;
+            }
+            entries->append(indexEntries[i]);
+        }
+        offset = header->previousIndex;
+    }
+    return true;
+}
+
+/* Walks the chunk headers from the start up to the first torn or corrupt chunk */
+void SessionReader::ScanChunks(QVector<SessionIndexEntry>* entries) const
+{
+    quint64 offset = Header().headerSize;
+    while (IsValidChunk(offset)) {
+        const SessionChunkHeader* header = reinterpret_cast<const SessionChunkHeader*>(data + offset);
+        if (header->type != SESSION_CHUNK_INDEX) {
+            SessionIndexEntry entry;
+            entry.offset = offset;
+            entry.type = header->type;
+            entry.source = header->source;
+            entry.channel = header->channel;
+            entry.count = header->count;
+            entry.reserved = 0;
+            entry.firstTime = header->firstTime;
+            entry.lastTime = header->lastTime;
+            entry.minValue = header->minValue;
+            entry.maxValue = header->maxValue;
+            entries->append(entry);
+        }
+        offset += sizeof(SessionChunkHeader) + header->payloadSize;
+    }
+}
+
+bool SessionReader::IsValidChunk(quint64 offset) const
+{
+    if (offset % 8 != 0 || offset + sizeof(SessionChunkHeader) > quint64(size)) {
+        return false;
+    }
+    const SessionChunkHeader* header = reinterpret_cast<const SessionChunkHeader*>(data + offset);
+    if (header->magic != SESSION_CHUNK_MAGIC || offset + sizeof(SessionChunkHeader) + header->payloadSize > quint64(size)) {
+        return false;
+    }
+    if (header->type == SESSION_CHUNK_SAMPLES) { // the payload must hold the samples and their summaries
+        const quint64 blocks = (quint64(header->count) + SESSION_SUMMARY_BLOCK - 1) / SESSION_SUMMARY_BLOCK;
+        return header->payloadSize == header->count * sizeof(SessionSample) + blocks * sizeof(SessionSummary);
+    }
+    return true;
+}
@@ -0,0 +1,50 @@
+#ifndef SESSIONREADER_H
+#define SESSIONREADER_H
+
+#include <QFile>
+#include <QVector>
+
+#include "sessionformat.h"
+
+/*
+ * Read-only view of a session file written by SessionRecorder. The file is memory mapped, so
+ * opening a multi-gigabyte session only reads the chunk index; sample data is paged in when it
+ * is accessed. The index comes from the file's index chunks if the recording was stopped cleanly,
+ * otherwise the chunk headers are walked once (everything up to a torn last chunk is usable).
+ */
+class SessionReader {
+public:
+    SessionReader() = default;
+    ~SessionReader() { Close(); }
+
+    bool Open(const QString& fileName);
+    void Close();
+    bool IsOpen() const { return data != nullptr; }
+
+    const SessionFileHeader& Header() const { return *reinterpret_cast<const SessionFileHeader*>(data); }
+    double StartTime() const { return Header().startTime; } // sample timestamps are relative to the recording clock
+    double Duration() const { return endTime - StartTime(); }
+
+    /* Sample chunks of all channels, ordered by their first timestamp */
+    const QVector<SessionIndexEntry>& Chunks() const { return chunks; }
+    /* Indexes into Chunks() of the chunks of one channel, ordered by time; empty if the channel wasn't recorded */
+    const QVector<int>& ChannelChunks(int channel) const;
+    QVector<int> Channels() const; // ids of every recorded channel
+
+    const SessionSample* Samples(const SessionIndexEntry& chunk) const;
+    const SessionSummary* Summaries(const SessionIndexEntry& chunk) const; // ceil(count / SESSION_SUMMARY_BLOCK) entries
+
+private:
+    QFile file;
+    const uchar* data = nullptr;
+    qint64 size = 0;
+    double endTime = 0;
+    QVector<SessionIndexEntry> chunks;
+    QVector<QVector<int>> channelChunks; // indexed by channel id
+
+    bool ReadIndexChain(quint64 lastIndex, QVector<SessionIndexEntry>* entries) const;
+    void ScanChunks(QVector<SessionIndexEntry>* entries) const;
+    bool IsValidChunk(quint64 offset) const;
+};
+
+#endif // SESSIONREADER_H
@@ -0,0 +1,374 @@
+#include "sessionrecorder.h"
+#include "hostclock.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <cstring>
+#include <limits>
+
+SessionRecorder::SessionRecorder(QObject* parent)
+    : QThread(parent)
+{
+    for (SourceState& state : sources) {
+        state.channels.resize(CHANNELS_PER_SOURCE);
+    }
+}
+
+SessionRecorder::~SessionRecorder()
+{
+    Stop();
+}
+
+bool SessionRecorder::Start(const QString& fileName, bool recordRaw)
+{
+    if (IsRecording()) {
+        Stop();
+    }
+
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "Can't record to" << fileName << file.errorString();
+        return false;
+    }
+
+    SessionFileHeader header;
+    std::memcpy(header.magic, SESSION_MAGIC, sizeof(header.magic));
+    header.version = SESSION_VERSION;
+    header.headerSize = sizeof(SessionFileHeader);
+    header.startTime = HostClock::Seconds();
+    header.startDateMs = QDateTime::currentMSecsSinceEpoch();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.flush();
+
+    this->recordRaw = recordRaw;
+    indexEntries.resize(0);
+    lastIndexOffset = 0;
+    bytesWritten.store(sizeof(header), std::memory_order_relaxed);
+    droppedChunks.store(0, std::memory_order_relaxed);
+    stopRequested = false;
+
+    QThread::start(QThread::LowPriority); // the serial threads and the gui come first
+    recording.store(true, std::memory_order_release);
+    return true;
+}
+
+void SessionRecorder::Stop()
+{
+    if (!IsRecording()) {
+        return;
+    }
+    recording.store(false, std::memory_order_release); // the serial threads stop adding before we take their buffers
+    for (int source = 0; source < MAX_SOURCES; source++) {
+        QMutexLocker locker(&sources[source].mutex);
+        FlushAll(source);
+    }
+
+    queueMutex.lock();
+    stopRequested = true;
+    queueReady.wakeOne();
+    queueMutex.unlock();
+    wait();
+    file.close();
+}
+
+void SessionRecorder::RecordSample(int source, const Sample& sample)
+{
+    if (!IsRecording()) {
+        return;
+    }
+    SourceState& state = sources[source];
+    QMutexLocker locker(&state.mutex); // only contended while Stop collects the buffers
+    if (!IsRecording()) {
+        return;
+    }
+
+    const int channel = sample.channel - source * CHANNELS_PER_SOURCE;
+    if (channel < 0 || channel >= CHANNELS_PER_SOURCE) {
+        return;
+    }
+    ChannelChunk& chunk = state.channels[channel];
+    if (chunk.samples.isEmpty()) {
+        if (chunk.samples.capacity() < SESSION_CHUNK_SAMPLE_COUNT) {
+            chunk.samples.reserve(SESSION_CHUNK_SAMPLE_COUNT);
+        }
+        chunk.minValue = sample.value;
+        chunk.maxValue = sample.value;
+        chunk.started = HostClock::Seconds();
+        state.pendingChannels.append(channel);
+        if (state.oldestPending <= 0) {
+            state.oldestPending = chunk.started;
+        }
+    }
+    SessionSample record;
+    record.timestamp = sample.timestamp;
+    record.value = sample.value;
+    chunk.samples.append(record);
+    chunk.minValue = qMin(chunk.minValue, sample.value);
+    chunk.maxValue = qMax(chunk.maxValue, sample.value);
+
+    if (chunk.samples.size() >= SESSION_CHUNK_SAMPLE_COUNT) {
+        FlushChannel(source, channel);
+        state.pendingChannels.removeOne(channel);
+        UpdateOldestPending(state);
+    }
+}
+
+void SessionRecorder::RecordRaw(int source, const char* data, int size, double timestamp)
+{
+    if (!recordRaw || size <= 0 || !IsRecording()) {
+        return;
+    }
+    SourceState& state = sources[source];
+    QMutexLocker locker(&state.mutex);
+    if (!IsRecording()) {
+        return;
+    }
+
+    if (state.raw.isEmpty()) {
+        state.raw.reserve(int(sizeof(SessionChunkHeader)) + SESSION_RAW_CHUNK_BYTES);
+        state.raw.resize(sizeof(SessionChunkHeader));
+        state.rawFirstTime = timestamp;
+        state.rawStarted = HostClock::Seconds();
+        if (state.oldestPending <= 0) {
+            state.oldestPending = state.rawStarted;
+        }
+    }
+    state.raw.append(data, size);
+    state.rawLastTime = timestamp;
+
+    if (state.raw.size() - int(sizeof(SessionChunkHeader)) >= SESSION_RAW_CHUNK_BYTES) {
+        FlushRaw(source);
+        UpdateOldestPending(state);
+    }
+}
+
+void SessionRecorder::FlushStale(int source)
+{
+    if (!IsRecording()) {
+        return;
+    }
+    SourceState& state = sources[source];
+    QMutexLocker locker(&state.mutex);
+    const double now = HostClock::Seconds();
+    if (state.oldestPending <= 0 || now - state.oldestPending < SESSION_FLUSH_INTERVAL) {
+        return;
+    }
+
+    for (int i = state.pendingChannels.size() - 1; i >= 0; i--) {
+        const int channel = state.pendingChannels[i];
+        if (now - state.channels[channel].started >= SESSION_FLUSH_INTERVAL) {
+            FlushChannel(source, channel);
+            state.pendingChannels.remove(i);
+        }
+    }
+    if (!state.raw.isEmpty() && now - state.rawStarted >= SESSION_FLUSH_INTERVAL) {
+        FlushRaw(source);
+    }
+    UpdateOldestPending(state);
+}
+
+/* The caller holds the source mutex and removes channel from pendingChannels */
+void SessionRecorder::FlushChannel(int source, int channel)
+{
+    ChannelChunk& chunk = sources[source].channels[channel];
+    const int count = chunk.samples.size();
+    const int blocks = (count + SESSION_SUMMARY_BLOCK - 1) / SESSION_SUMMARY_BLOCK;
+    const int samplesSize = count * int(sizeof(SessionSample));
+
+    SessionChunkHeader header;
+    header.magic = SESSION_CHUNK_MAGIC;
+    header.type = SESSION_CHUNK_SAMPLES;
+    header.source = quint16(source);
+    header.channel = source * CHANNELS_PER_SOURCE + channel;
+    header.count = quint32(count);
+    header.payloadSize = quint32(samplesSize + blocks * int(sizeof(SessionSummary)));
+    header.reserved = 0;
+    header.firstTime = chunk.samples.first().timestamp;
+    header.lastTime = chunk.samples.last().timestamp;
+    header.minValue = chunk.minValue;
+    header.maxValue = chunk.maxValue;
+    header.previousIndex = 0;
+
+    QByteArray bytes(int(sizeof(header) + header.payloadSize), Qt::Uninitialized);
+    char* out = bytes.data();
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    std::memcpy(out, chunk.samples.constData(), samplesSize);
+    out += samplesSize;
+
+    const SessionSample* samples = chunk.samples.constData();
+    for (int from = 0; from < count; from += SESSION_SUMMARY_BLOCK) {
+        const int to = qMin(from + SESSION_SUMMARY_BLOCK, count);
+        SessionSummary summary;
+        summary.minValue = samples[from].value;
+        summary.maxValue = samples[from].value;
+        for (int i = from + 1; i < to; i++) {
+            summary.minValue = qMin(summary.minValue, samples[i].value);
+            summary.maxValue = qMax(summary.maxValue, samples[i].value);
+        }
+        std::memcpy(out, &summary, sizeof(summary));
+        out += sizeof(summary);
+    }
+
+    chunk.samples.resize(0); // keeps the capacity for the next chunk
+    Enqueue(bytes);
+}
+
+/* The caller holds the source mutex */
+void SessionRecorder::FlushRaw(int source)
+{
+    SourceState& state = sources[source];
+    if (state.raw.isEmpty()) {
+        return;
+    }
+
+    SessionChunkHeader header;
+    header.magic = SESSION_CHUNK_MAGIC;
+    header.type = SESSION_CHUNK_RAW;
+    header.source = quint16(source);
+    header.channel = -1;
+    header.count = quint32(state.raw.size() - int(sizeof(header)));
+    header.payloadSize = (header.count + 7) & ~quint32(7); // padded, so every chunk header stays 8 byte aligned for mapped readers
+    header.reserved = 0;
+    header.firstTime = state.rawFirstTime;
+    header.lastTime = state.rawLastTime;
+    header.minValue = 0;
+    header.maxValue = 0;
+    header.previousIndex = 0;
+    state.raw.append(QByteArray(int(header.payloadSize - header.count), '\0'));
+    std::memcpy(state.raw.data(), &header, sizeof(header));
+
+    Enqueue(state.raw);
+    state.raw = QByteArray(); // the queued copy is the only reference, no deep copy
+}
+
+void SessionRecorder::FlushAll(int source)
+{
+    SourceState& state = sources[source];
+    for (int channel : state.pendingChannels) {
+        FlushChannel(source, channel);
+    }
+    state.pendingChannels.resize(0);
+    FlushRaw(source);
+    state.oldestPending = 0;
+}
+
+void SessionRecorder::UpdateOldestPending(SourceState& state)
+{
+    double oldest = state.raw.isEmpty() ? 0 : state.rawStarted;
+    for (int channel : state.pendingChannels) {
+        const double started = state.channels[channel].started;
+        if (oldest <= 0 || started < oldest) {
+            oldest = started;
+        }
+    }
+    state.oldestPending = oldest;
+}
+
+void SessionRecorder::Enqueue(QByteArray chunk)
+{
+    QMutexLocker locker(&queueMutex);
+    if (queuedBytes + chunk.size() > SESSION_MAX_QUEUED_BYTES) {
+        droppedChunks.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    queuedBytes += chunk.size();
+    queue.append(chunk);
+    queueReady.wakeOne();
+}
+
+void SessionRecorder::run()
+{
+    QVector<QByteArray> pending;
+    QMutexLocker locker(&queueMutex);
+    for (;;) {
+        while (queue.isEmpty() && !stopRequested) {
+            queueReady.wait(&queueMutex);
+        }
+        if (queue.isEmpty()) {
+            break; // stop requested and everything written
+        }
+        pending.swap(queue);
+        queuedBytes = 0;
+        locker.unlock();
+
+        for (const QByteArray& chunk : pending) {
+            WriteChunk(chunk);
+        }
+        pending.resize(0);
+        file.flush(); // a crash loses at most the chunks still in the queue
+
+        locker.relock();
+    }
+    locker.unlock();
+
+    if (!indexEntries.isEmpty()) {
+        WriteIndex();
+    }
+    if (lastIndexOffset > 0) {
+        SessionFileTrailer trailer;
+        trailer.lastIndex = lastIndexOffset;
+        trailer.magic = SESSION_TRAILER_MAGIC;
+        trailer.reserved = 0;
+        file.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+        bytesWritten.fetch_add(sizeof(trailer), std::memory_order_relaxed);
+    }
+    file.flush();
+}
+
+void SessionRecorder::WriteChunk(const QByteArray& chunk)
+{
+    SessionChunkHeader header;
+    std::memcpy(&header, chunk.constData(), sizeof(header));
+
+    SessionIndexEntry entry;
+    entry.offset = quint64(file.pos());
+    entry.type = header.type;
+    entry.source = header.source;
+    entry.channel = header.channel;
+    entry.count = header.count;
+    entry.reserved = 0;
+    entry.firstTime = header.firstTime;
+    entry.lastTime = header.lastTime;
+    entry.minValue = header.minValue;
+    entry.maxValue = header.maxValue;
+
+    if (file.write(chunk) != chunk.size()) {
+        qDebug() << "Recording to" << file.fileName() << "failed:" << file.errorString();
+        droppedChunks.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    bytesWritten.fetch_add(quint64(chunk.size()), std::memory_order_relaxed);
+    indexEntries.append(entry);
+    if (indexEntries.size() >= SESSION_INDEX_INTERVAL) {
+        WriteIndex();
+    }
+}
+
+void SessionRecorder::WriteIndex()
+{
+    SessionChunkHeader header;
+    header.magic = SESSION_CHUNK_MAGIC;
+    header.type = SESSION_CHUNK_INDEX;
+    header.source = 0;
+    header.channel = -1;
+    header.count = quint32(indexEntries.size());
+    header.payloadSize = quint32(indexEntries.size() * int(sizeof(SessionIndexEntry)));
+    header.reserved = 0;
+    header.firstTime = std::numeric_limits<double>::max();
+    header.lastTime = -std::numeric_limits<double>::max();
+    for (const SessionIndexEntry& entry : indexEntries) {
+        header.firstTime = qMin(header.firstTime, entry.firstTime);
+        header.lastTime = qMax(header.lastTime, entry.lastTime);
+    }
+    header.minValue = 0;
+    header.maxValue = 0;
+    header.previousIndex = lastIndexOffset;
+
+    const quint64 offset = quint64(file.pos());
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(indexEntries.constData()), header.payloadSize);
+    bytesWritten.fetch_add(sizeof(header) + header.payloadSize, std::memory_order_relaxed);
+    lastIndexOffset = offset;
+    indexEntries.resize(0);
+}
@@ -0,0 +1,92 @@
+#ifndef SESSIONRECORDER_H
+#define SESSIONRECORDER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+#include <atomic>
+
+#include "config.h"
+#include "sample.h"
+#include "sessionformat.h"
+
+/*
+ * Streams every decoded sample (and optionally the raw port bytes) to a session file, see
+ * sessionformat.h for the layout. The serial threads only append to per-channel buffers; full or
+ * stale buffers are handed over as finished chunks to the writer thread, which does all file io.
+ * A disk that can't keep up costs dropped chunks (DroppedChunks), never a stalled serial thread.
+ */
+class SessionRecorder : public QThread {
+    Q_OBJECT
+
+public:
+    explicit SessionRecorder(QObject* parent = nullptr);
+    ~SessionRecorder();
+
+    bool Start(const QString& fileName, bool recordRaw); // false if the file can't be created
+    void Stop(); // writes everything recorded so far, the final index and closes the file
+    bool IsRecording() const { return recording.load(std::memory_order_acquire); }
+    QString FileName() const { return file.fileName(); }
+    quint64 BytesWritten() const { return bytesWritten.load(std::memory_order_relaxed); }
+    quint64 DroppedChunks() const { return droppedChunks.load(std::memory_order_relaxed); }
+
+    // called by the serial threads, each source only from its own thread
+    void RecordSample(int source, const Sample& sample);
+    void RecordRaw(int source, const char* data, int size, double timestamp);
+    void FlushStale(int source); // hand over buffers that waited longer than SESSION_FLUSH_INTERVAL
+
+protected:
+    void run() override;
+
+private:
+    /* Samples of one channel that don't fill a chunk yet */
+    struct ChannelChunk {
+        QVector<SessionSample> samples;
+        double minValue;
+        double maxValue;
+        double started; // HostClock seconds of the first sample
+    };
+
+    /* Recording state of one serial source, only touched by its thread and by Stop */
+    struct SourceState {
+        QMutex mutex;
+        QVector<ChannelChunk> channels; // indexed by device channel (0..255)
+        QVector<int> pendingChannels; // channels with samples
+        QByteArray raw; // SessionChunkHeader placeholder followed by the raw bytes
+        double rawFirstTime = 0;
+        double rawLastTime = 0;
+        double rawStarted = 0;
+        double oldestPending = 0; // started time of the oldest buffer, 0 if nothing is pending
+    };
+
+    std::atomic<bool> recording { false };
+    bool recordRaw = false;
+    SourceState sources[MAX_SOURCES];
+
+    // handed over chunks, written by run()
+    QMutex queueMutex;
+    QWaitCondition queueReady;
+    QVector<QByteArray> queue;
+    qint64 queuedBytes = 0;
+    bool stopRequested = false;
+
+    // writer thread only
+    QFile file;
+    QVector<SessionIndexEntry> indexEntries; // chunks written since the last index chunk
+    quint64 lastIndexOffset = 0;
+    std::atomic<quint64> bytesWritten { 0 };
+    std::atomic<quint64> droppedChunks { 0 };
+
+    void FlushChannel(int source, int channel);
+    void FlushRaw(int source);
+    void FlushAll(int source);
+    void UpdateOldestPending(SourceState& state);
+    void Enqueue(QByteArray chunk);
+    void WriteChunk(const QByteArray& chunk);
+    void WriteIndex();
+};
+
+#endif // SESSIONRECORDER_H
@@ -0,0 +1,168 @@
+#include "sessionreplayer.h"
+#include "config.h"
+#include "hostclock.h"
+
+#include <algorithm>
+
+static bool SampleBefore(const SessionSample& sample, double timestamp)
+{
+    return sample.timestamp < timestamp;
+}
+
+SessionReplayer::SessionReplayer(QObject* parent)
+    : QObject(parent)
+    , sampleRing(SAMPLE_RING_CAPACITY)
+    , timer(this) // a child, so it moves to the replay thread with us
+{
+    timer.setTimerType(Qt::PreciseTimer);
+    timer.setInterval(REPLAY_TICK_MS);
+    connect(&timer, SIGNAL(timeout()), this, SLOT(Tick()));
+}
+
+void SessionReplayer::Open(QString fileName)
+{
+    Close();
+    if (!reader.Open(fileName)) {
+        emit openFailed();
+        return;
+    }
+    duration.store(reader.Duration(), std::memory_order_relaxed);
+    Seek(0);
+    emit opened(reader.Duration());
+}
+
+void SessionReplayer::Close()
+{
+    Pause();
+    active.clear();
+    nextChunk = 0;
+    reader.Close();
+    position.store(0, std::memory_order_relaxed);
+    duration.store(0, std::memory_order_relaxed);
+}
+
+void SessionReplayer::Play(double speed)
+{
+    if (!reader.IsOpen()) {
+        return;
+    }
+    this->speed = speed;
+    playOrigin = Position();
+    playHost = HostClock::Seconds();
+    playing = true;
+    timer.start();
+}
+
+void SessionReplayer::Pause()
+{
+    playing = false;
+    timer.stop();
+}
+
+void SessionReplayer::Seek(double seconds)
+{
+    if (!reader.IsOpen()) {
+        return;
+    }
+    seconds = qBound(0.0, seconds, reader.Duration());
+    const double timestamp = reader.StartTime() + seconds;
+    const QVector<SessionIndexEntry>& chunks = reader.Chunks();
+
+    /* only the index is consulted to find the chunks around the new position */
+    active.resize(0);
+    nextChunk = chunks.size();
+    for (int i = 0; i < chunks.size(); i++) {
+        const SessionIndexEntry& chunk = chunks[i];
+        if (chunk.firstTime >= timestamp) {
+            nextChunk = i;
+            break;
+        }
+        if (chunk.lastTime >= timestamp) {
+            const SessionSample* samples = reader.Samples(chunk);
+            Cursor cursor;
+            cursor.chunk = i;
+            cursor.next = int(std::lower_bound(samples, samples + chunk.count, timestamp, SampleBefore) - samples);
+            active.append(cursor);
+        }
+    }
+
+    position.store(seconds, std::memory_order_relaxed);
+    playOrigin = seconds;
+    playHost = HostClock::Seconds();
+}
+
+void SessionReplayer::Tick()
+{
+    if (!playing) {
+        return;
+    }
+
+    int budget = sampleRing.FreeSpace();
+    if (speed > 0) {
+        const double target = playOrigin + (HostClock::Seconds() - playHost) * speed;
+        if (!PlayUntil(target, &budget)) {
+            /* the gui is behind; carry on from here next tick instead of catching up in a burst */
+            playOrigin = Position();
+            playHost = HostClock::Seconds();
+            return;
+        }
+        position.store(qMin(target, reader.Duration()), std::memory_order_relaxed);
+    } else {
+        /* as fast as possible: advance in steps until the ring is full */
+        while (!AtEnd()) {
+            double target = Position() + REPLAY_FAST_STEP;
+            if (active.isEmpty()) { // skip gaps without samples in one go
+                target = qMax(target, reader.Chunks()[nextChunk].firstTime - reader.StartTime());
+            }
+            if (!PlayUntil(target, &budget)) {
+                return;
+            }
+            position.store(qMin(target, reader.Duration()), std::memory_order_relaxed);
+        }
+    }
+
+    if (AtEnd()) {
+        Pause();
+        position.store(reader.Duration(), std::memory_order_relaxed);
+        emit finished();
+    }
+}
+
+bool SessionReplayer::PlayUntil(double target, int* budget)
+{
+    const QVector<SessionIndexEntry>& chunks = reader.Chunks();
+    const double start = reader.StartTime();
+    const double timestamp = start + target;
+
+    while (nextChunk < chunks.size() && chunks[nextChunk].firstTime <= timestamp) {
+        Cursor cursor;
+        cursor.chunk = nextChunk++;
+        cursor.next = 0;
+        active.append(cursor);
+    }
+
+    for (int i = 0; i < active.size();) {
+        Cursor& cursor = active[i];
+        const SessionIndexEntry& chunk = chunks[cursor.chunk];
+        const SessionSample* samples = reader.Samples(chunk);
+        const int count = int(chunk.count);
+        while (cursor.next < count && samples[cursor.next].timestamp <= timestamp) {
+            if (*budget <= 0) {
+                return false;
+            }
+            Sample sample;
+            sample.timestamp = samples[cursor.next].timestamp - start;
+            sample.value = samples[cursor.next].value;
+            sample.channel = chunk.channel;
+            sampleRing.Push(sample);
+            (*budget)--;
+            cursor.next++;
+        }
+        if (cursor.next >= count) {
+            active.remove(i);
+        } else {
+            i++;
+        }
+    }
+    return true;
+}
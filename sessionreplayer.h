@@ -0,0 +1,65 @@
+#ifndef SESSIONREPLAYER_H
+#define SESSIONREPLAYER_H
+
+#include <QObject>
+#include <QTimer>
+#include <atomic>
+
+#include "sample.h"
+#include "sessionreader.h"
+#include "spscring.h"
+
+/*
+ * Plays a recorded session back through a sample ring, so the gui ingests it exactly like the
+ * samples of a SerialWorker. Lives on its own thread; the file is memory mapped, so only the
+ * chunks around the play position are paged in. Replayed timestamps are seconds since the start
+ * of the session. The ring is never overrun: playback waits for the gui instead of dropping.
+ */
+class SessionReplayer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit SessionReplayer(QObject* parent = nullptr);
+
+    SpscRing<Sample>* SampleRing() { return &sampleRing; } // drained by the gui thread
+    double Position() const { return position.load(std::memory_order_relaxed); } // seconds since the start of the session
+    double Duration() const { return duration.load(std::memory_order_relaxed); }
+
+public slots:
+    void Open(QString fileName); // paused at the start, emits opened or openFailed
+    void Close();
+    void Play(double speed); // 1 is real time, N is N times faster, 0 is as fast as the gui takes the samples
+    void Pause();
+    void Seek(double seconds); // the samples already in the ring are from before the seek
+signals:
+    void opened(double duration);
+    void openFailed();
+    void finished();
+
+private slots:
+    void Tick();
+
+private:
+    /* Play position inside a chunk that began before the current time */
+    struct Cursor {
+        int chunk; // index into reader.Chunks()
+        int next; // first sample not played yet
+    };
+
+    SessionReader reader;
+    SpscRing<Sample> sampleRing;
+    QTimer timer;
+    QVector<Cursor> active; // ordered by chunk start, so each channel stays in time order
+    int nextChunk = 0; // first chunk that hasn't started yet
+    double speed = 1;
+    bool playing = false;
+    double playOrigin = 0; // session seconds at playHost
+    double playHost = 0; // HostClock seconds
+    std::atomic<double> position { 0 };
+    std::atomic<double> duration { 0 };
+
+    bool PlayUntil(double target, int* budget); // false if the ring filled up first
+    bool AtEnd() const { return active.isEmpty() && nextChunk >= reader.Chunks().size(); }
+};
+
+#endif // SESSIONREPLAYER_H
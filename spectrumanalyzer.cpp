@@ -0,0 +1,103 @@
+#include "spectrumanalyzer.h"
+
+#include <QtMath>
+
+SpectrumAnalyzer::SpectrumAnalyzer(int size, int hop)
+    : size(2)
+    , hop(qMax(1, hop))
+{
+    int bits = 1;
+    while (this->size < size) {
+        this->size *= 2;
+        bits++;
+    }
+
+    times.resize(this->size);
+    values.resize(this->size);
+    buffer.resize(this->size);
+    spectrum.resize(Bins());
+
+    window.resize(this->size);
+    bitReversed.resize(this->size);
+    for (int i = 0; i < this->size; i++) {
+        window[i] = 0.5 - 0.5 * qCos(2 * M_PI * i / this->size);
+        windowSum += window[i];
+        int reversed = 0;
+        for (int bit = 0; bit < bits; bit++) {
+            reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+        }
+        bitReversed[i] = reversed;
+    }
+    twiddles.resize(this->size / 2);
+    for (int k = 0; k < this->size / 2; k++) {
+        twiddles[k] = std::polar(1.0, -2 * M_PI * k / this->size);
+    }
+}
+
+void SpectrumAnalyzer::Reset()
+{
+    next = 0;
+    count = 0;
+    sinceSpectrum = 0;
+    timestamp = 0;
+    sampleRate = 0;
+}
+
+bool SpectrumAnalyzer::Add(double timestamp, double value)
+{
+    times[next] = timestamp;
+    values[next] = value;
+    next = (next + 1) % size;
+
+    if (count < size) {
+        if (++count < size) {
+            return false;
+        }
+    } else if (++sinceSpectrum < hop) {
+        return false;
+    }
+    sinceSpectrum = 0;
+    Compute();
+    return true;
+}
+
+void SpectrumAnalyzer::Compute()
+{
+    /* the ring is full, so next is the oldest sample; the mean is removed so the offset of
+       the signal doesn't leak into the low bins */
+    double mean = 0;
+    for (int i = 0; i < size; i++) {
+        mean += values[i];
+    }
+    mean /= size;
+    for (int i = 0; i < size; i++) {
+        buffer[bitReversed[i]] = (values[(next + i) % size] - mean) * window[i];
+    }
+    Transform();
+
+    const double amplitude = 2 / windowSum; // a sine's peak bin holds amplitude * windowSum / 2
+    for (int bin = 0; bin < spectrum.size(); bin++) {
+        const double scale = bin == 0 || bin == size / 2 ? amplitude / 2 : amplitude;
+        spectrum[bin] = 20 * std::log10(std::abs(buffer[bin]) * scale + 1e-12);
+    }
+
+    const double first = times[next];
+    const double last = times[(next + size - 1) % size];
+    timestamp = (first + last) / 2;
+    sampleRate = last > first ? (size - 1) / (last - first) : 0;
+}
+
+void SpectrumAnalyzer::Transform()
+{
+    for (int length = 2; length <= size; length *= 2) {
+        const int half = length / 2;
+        const int step = size / length;
+        for (int start = 0; start < size; start += length) {
+            for (int j = 0; j < half; j++) {
+                const std::complex<double> t = twiddles[j * step] * buffer[start + j + half];
+                buffer[start + j + half] = buffer[start + j] - t;
+                buffer[start + j] += t;
+            }
+        }
+    }
+}
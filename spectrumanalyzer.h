@@ -0,0 +1,52 @@
+#ifndef SPECTRUMANALYZER_H
+#define SPECTRUMANALYZER_H
+
+#include <QVector>
+#include <complex>
+
+/*
+ * Sliding window spectrum of one channel. Keeps the last 'size' samples and every 'hop' samples
+ * transforms them with a Hann window and an in-place radix-2 FFT. The FFT assumes evenly spaced
+ * samples; the sample rate is estimated from the timestamps of the window, so a device that sends
+ * at a steady rate gives the right frequencies without being configured.
+ */
+class SpectrumAnalyzer {
+public:
+    SpectrumAnalyzer(int size, int hop); // size is rounded up to a power of two
+
+    void Reset();
+    bool Add(double timestamp, double value); // true when a new spectrum is ready
+
+    int Size() const { return size; }
+    int Bins() const { return size / 2 + 1; } // DC up to the Nyquist frequency
+    const QVector<double>& Spectrum() const { return spectrum; } // dB per bin, 0 dB is a sine of amplitude 1
+    double Timestamp() const { return timestamp; } // center of the window of Spectrum()
+    double SampleRate() const { return sampleRate; } // estimated over the window of Spectrum(), 0 if unknown
+
+private:
+    int size;
+    int hop;
+
+    // ring of the last size samples
+    QVector<double> times;
+    QVector<double> values;
+    int next = 0;
+    int count = 0;
+    int sinceSpectrum = 0;
+
+    // computed once for the size
+    QVector<double> window;
+    double windowSum = 0;
+    QVector<int> bitReversed;
+    QVector<std::complex<double>> twiddles; // exp(-2 pi i k / size) for k < size / 2
+
+    QVector<std::complex<double>> buffer;
+    QVector<double> spectrum;
+    double timestamp = 0;
+    double sampleRate = 0;
+
+    void Compute();
+    void Transform(); // buffer must hold the input in bit reversed order
+};
+
+#endif // SPECTRUMANALYZER_H
@@ -0,0 +1,85 @@
+#include "spectrumviewer.h"
+#include "config.h"
+
+#include <QVBoxLayout>
+#include <algorithm>
+
+SpectrumViewer::SpectrumViewer(const ChannelRegistry& channelRegistry, int channel, QWidget* parent)
+    : QWidget(parent, Qt::Window)
+    , channel(channel)
+    , analyzer(SPECTRUM_FFT_SIZE, SPECTRUM_HOP)
+{
+    setAttribute(Qt::WA_DeleteOnClose);
+    resize(1000, 500);
+    if (channel < channelRegistry.Size() && channelRegistry.Info(channel).IsValid()) {
+        setWindowTitle("Spectrum of " + channelRegistry.Info(channel).name);
+    } else {
+        setWindowTitle(QString("Spectrum of channel %1").arg(channel));
+    }
+
+    plot = new QCustomPlot(this);
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(plot);
+
+    QSharedPointer<QCPAxisTickerTime> timeTicker(new QCPAxisTickerTime);
+    timeTicker->setTimeFormat("%h:%m:%s");
+    plot->xAxis->setTicker(timeTicker);
+    plot->yAxis->setLabel("Hz");
+
+    waterfall = new QCPWaterfall(plot->xAxis, plot->yAxis);
+    waterfall->setSize(SPECTRUM_COLUMNS, analyzer.Bins());
+
+    colorScale = new QCPColorScale(plot);
+    plot->plotLayout()->addElement(0, 1, colorScale);
+    colorScale->setType(QCPAxis::atRight);
+    colorScale->axis()->setLabel("dB");
+    waterfall->setColorScale(colorScale);
+    waterfall->setGradient(QCPColorGradient::gpThermal); // after setColorScale, which takes over the scale's empty gradient
+    QCPMarginGroup* marginGroup = new QCPMarginGroup(plot); // keeps the color scale as high as the axis rect
+    plot->axisRect()->setMarginGroup(QCP::msBottom | QCP::msTop, marginGroup);
+    colorScale->setMarginGroup(QCP::msBottom | QCP::msTop, marginGroup);
+}
+
+void SpectrumViewer::AddSamples(const QVector<double>& keys, const QVector<double>& values)
+{
+    bool added = false;
+    for (int i = 0; i < keys.size(); i++) {
+        if (!analyzer.Add(keys[i], values[i])) {
+            continue;
+        }
+        const double rate = analyzer.SampleRate();
+        if (rate <= 0) {
+            continue;
+        }
+        /* the rows are frequencies of the current rate, older columns would be mislabeled */
+        if (sampleRate == 0 || qAbs(rate - sampleRate) > sampleRate * SPECTRUM_RATE_TOLERANCE) {
+            sampleRate = rate;
+            dataRangeSet = false;
+            waterfall->clear();
+            waterfall->setValueRange(QCPRange(0, rate / 2));
+            plot->yAxis->setRange(0, rate / 2);
+        }
+        const QVector<double>& spectrum = analyzer.Spectrum();
+        if (!dataRangeSet) {
+            const double peak = *std::max_element(spectrum.constBegin(), spectrum.constEnd());
+            waterfall->setDataRange(QCPRange(peak - SPECTRUM_DYNAMIC_RANGE_DB, peak));
+            dataRangeSet = true;
+        }
+        waterfall->addColumn(analyzer.Timestamp(), spectrum);
+        added = true;
+    }
+    if (added) {
+        waterfall->rescaleKeyAxis();
+        plot->replot(QCustomPlot::rpQueuedReplot);
+    }
+}
+
+void SpectrumViewer::Clear()
+{
+    analyzer.Reset();
+    waterfall->clear();
+    sampleRate = 0;
+    dataRangeSet = false;
+    plot->replot(QCustomPlot::rpQueuedReplot);
+}
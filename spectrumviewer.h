@@ -0,0 +1,36 @@
+#ifndef SPECTRUMVIEWER_H
+#define SPECTRUMVIEWER_H
+
+#include <QWidget>
+
+#include "channelregistry.h"
+#include "qcustomplot.h"
+#include "spectrumanalyzer.h"
+
+/*
+ * Window with the running spectrum of one channel as a waterfall: time runs along x, frequency
+ * along y and the color is the level in dB. The MainWindow forwards the samples of the channel
+ * as they are plotted; every SPECTRUM_HOP samples a new column is transformed and appended, and
+ * the oldest column scrolls out once SPECTRUM_COLUMNS are shown.
+ */
+class SpectrumViewer : public QWidget {
+    Q_OBJECT
+
+public:
+    SpectrumViewer(const ChannelRegistry& channelRegistry, int channel, QWidget* parent = nullptr);
+
+    int Channel() const { return channel; }
+    void AddSamples(const QVector<double>& keys, const QVector<double>& values);
+    void Clear(); // the samples start over, e.g. a replay
+
+private:
+    int channel;
+    SpectrumAnalyzer analyzer;
+    QCustomPlot* plot;
+    QCPWaterfall* waterfall;
+    QCPColorScale* colorScale;
+    double sampleRate = 0; // of the columns in the waterfall, 0 before the first one
+    bool dataRangeSet = false;
+};
+
+#endif // SPECTRUMVIEWER_H
@@ -0,0 +1,74 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <QVector>
+#include <atomic>
+
+/*
+ * Preallocated lock-free ring for exactly one producer thread and one consumer thread.
+ * Push never blocks or allocates: when the consumer falls behind the new item is dropped
+ * and counted, so a stalled gui can't back up the serial thread.
+ */
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(int minCapacity)
+    {
+        int capacity = 1;
+        while (capacity < minCapacity) {
+            capacity <<= 1;
+        }
+        buffer.resize(capacity);
+        mask = capacity - 1;
+    }
+
+    // producer side
+    bool Push(const T& item)
+    {
+        const quint64 h = head.load(std::memory_order_relaxed);
+        if (h - cachedTail > quint64(mask)) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h - cachedTail > quint64(mask)) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        buffer[int(h & mask)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // producer side; how many items Push can take right now without dropping
+    int FreeSpace() const
+    {
+        return mask + 1 - int(head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire));
+    }
+
+    // consumer side; copies up to maxCount items into out and returns how many
+    int Pop(T* out, int maxCount)
+    {
+        const quint64 t = tail.load(std::memory_order_relaxed);
+        const quint64 available = head.load(std::memory_order_acquire) - t;
+        const int count = int(qMin(available, quint64(maxCount)));
+        for (int i = 0; i < count; i++) {
+            out[i] = buffer[int((t + i) & mask)];
+        }
+        tail.store(t + count, std::memory_order_release);
+        return count;
+    }
+
+    bool IsEmpty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_relaxed); }
+    int Capacity() const { return mask + 1; }
+    quint64 Dropped() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    QVector<T> buffer;
+    int mask;
+
+    alignas(64) std::atomic<quint64> head { 0 }; // written by the producer only
+    quint64 cachedTail = 0; // producer's last view of tail
+    alignas(64) std::atomic<quint64> tail { 0 }; // written by the consumer only
+    std::atomic<quint64> dropped { 0 };
+};
+
+#endif // SPSCRING_H